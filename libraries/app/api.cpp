@@ -105,6 +105,12 @@ namespace graphene { namespace app {
           if( _app.get_plugin( "debug_witness" ) )
              _debug_api = std::make_shared< graphene::debug_witness::debug_api >( std::ref(_app) );
        }
+       else if( api_name == "witness_api" )
+       {
+          // can only enable this API if the plugin was loaded
+          if( _app.get_plugin( "witness" ) )
+             _witness_api = std::make_shared< graphene::witness_plugin::witness_api >( std::ref(_app) );
+       }
        return;
     }
 
@@ -119,10 +125,11 @@ namespace graphene { namespace app {
        {
           /// we need to ensure the database_api is not deleted for the life of the async operation
           auto capture_this = shared_from_this();
+          const sealed_block* sealed = _app.chain_database()->get_applying_block();
           for( uint32_t trx_num = 0; trx_num < b.transactions.size(); ++trx_num )
           {
              const auto& trx = b.transactions[trx_num];
-             auto id = trx.id();
+             auto id = sealed != nullptr ? sealed->transactions()[trx_num].id() : trx.id();
              auto itr = _callbacks.find(id);
              if( itr != _callbacks.end() )
              {
@@ -233,7 +240,13 @@ namespace graphene { namespace app {
        return *_debug_api;
     }
 
-    vector<account_id_type> get_relevant_accounts( const object* obj )
+    fc::api<graphene::witness_plugin::witness_api> login_api::witness() const
+    {
+       FC_ASSERT(_witness_api);
+       return *_witness_api;
+    }
+
+    vector<account_id_type> get_relevant_accounts( const object* obj, const database& db )
     {
        vector<account_id_type> result;
        if( obj->id.space() == protocol_ids )
@@ -344,8 +357,20 @@ namespace graphene { namespace app {
                } case impl_transaction_object_type:{
                   const auto& aobj = dynamic_cast<const transaction_object*>(obj);
                   assert( aobj != nullptr );
+                  /** only the id is kept, the body comes from the recent transactions or its block */
+                  optional<signed_transaction> trx = db.get_recent_transaction_cache().find( aobj->trx_id );
+                  if( !trx.valid() )
+                  {
+                     auto block = db.fetch_block_by_number( aobj->block_num );
+                     if( block.valid() )
+                        for( const auto& t : block->transactions )
+                           if( t.id() == aobj->trx_id )
+                              trx = t;
+                  }
+                  if( !trx.valid() )
+                     break;
                   flat_set<account_id_type> impacted;
-                  transaction_get_impacted_accounts( aobj->trx, impacted );
+                  transaction_get_impacted_accounts( *trx, impacted );
                   result.reserve( impacted.size() );
                   for( auto& item : impacted ) result.emplace_back(item);
                   break;
@@ -375,7 +400,7 @@ namespace graphene { namespace app {
           }
        }
        return result;
-    } // end get_relevant_accounts( obj )
+    } // end get_relevant_accounts( obj, db )
 
     vector<order_history_object> history_api::get_fill_order_history( asset_id_type a, asset_id_type b, uint32_t limit  )const
     {
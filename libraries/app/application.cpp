@@ -26,6 +26,7 @@
 #include <graphene/app/application.hpp>
 #include <graphene/app/plugin.hpp>
 
+#include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/time/time.hpp>
@@ -69,6 +70,8 @@ using net::trx_message;
 using chain::block_header;
 using chain::signed_block_header;
 using chain::signed_block;
+using chain::sealed_block;
+using chain::sealed_transaction;
 using chain::block_id_type;
 
 using std::vector;
@@ -386,6 +389,44 @@ namespace detail {
             _chain_db->open(_data_dir / "blockchain", initial_state);
          }
 
+         if( _options->count("worker-threads") )
+            _chain_db->set_worker_thread_count( _options->at("worker-threads").as<uint32_t>() );
+         if( _options->count("verified-transaction-cache-size") )
+            _chain_db->get_verified_transaction_cache().set_max_size( _options->at("verified-transaction-cache-size").as<uint32_t>() );
+         if( _options->count("track-transaction-conflicts") )
+            _chain_db->set_track_transaction_conflicts( true );
+         if( _options->count("speculative-execution") )
+            _chain_db->set_speculative_execution( true );
+         if( _options->count("profile-operations") )
+            _chain_db->get_operation_profiler().enable( true );
+         if( _options->count("max-pending-transactions") || _options->count("max-pending-transactions-mb") )
+         {
+            auto pool_stats = _chain_db->get_pending_transaction_pool().get_stats();
+            uint32_t max_count = pool_stats.max_size;
+            uint64_t max_bytes = pool_stats.max_bytes;
+            if( _options->count("max-pending-transactions") )
+               max_count = _options->at("max-pending-transactions").as<uint32_t>();
+            if( _options->count("max-pending-transactions-mb") )
+               max_bytes = uint64_t( _options->at("max-pending-transactions-mb").as<uint32_t>() ) * 1024 * 1024;
+            _chain_db->get_pending_transaction_pool().set_limits( max_count, max_bytes );
+         }
+         if( _options->count("max-pending-transactions-per-account") || _options->count("max-pending-transactions-kb-per-account") )
+         {
+            uint32_t max_count = 0;
+            uint64_t max_bytes = 0;
+            if( _options->count("max-pending-transactions-per-account") )
+               max_count = _options->at("max-pending-transactions-per-account").as<uint32_t>();
+            if( _options->count("max-pending-transactions-kb-per-account") )
+               max_bytes = uint64_t( _options->at("max-pending-transactions-kb-per-account").as<uint32_t>() ) * 1024;
+            _chain_db->get_pending_transaction_pool().set_fee_payer_quota( max_count, max_bytes );
+         }
+         if( _options->count("pending-quota-exempt-account") )
+         {
+            flat_set<account_id_type> exempt;
+            LOAD_VALUE_SET( (*_options), "pending-quota-exempt-account", exempt, account_id_type )
+            _chain_db->get_pending_transaction_pool().set_quota_exempt_fee_payers( std::move(exempt) );
+         }
+
          if( _options->count("force-validate") )
          {
             ilog( "All transaction signatures will be validated" );
@@ -482,7 +523,8 @@ namespace detail {
             // you can help the network code out by throwing a block_older_than_undo_history exception.
             // when the net code sees that, it will stop trying to push blocks from that chain, but
             // leave that peer connected so that they can get sync blocks from us
-            bool result = _chain_db->push_block(blk_msg.block, (_is_block_producer | _force_validate) ? database::skip_nothing : database::skip_transaction_signatures);
+            sealed_block block = _chain_db->seal_block(blk_msg.block);
+            bool result = _chain_db->push_block(block, (_is_block_producer | _force_validate) ? database::skip_nothing : database::skip_transaction_signatures);
 
             // the block was accepted, so we now know all of the transactions contained in the block
             if (!sync_mode)
@@ -492,11 +534,15 @@ namespace detail {
                // happens, there's no reason to fetch the transactions, so  construct a list of the
                // transaction message ids we no longer need.
                // during sync, it is unlikely that we'll see any old
-               for (const processed_transaction& transaction : blk_msg.block.transactions)
-               {
-                  graphene::net::trx_message transaction_message(transaction);
-                  contained_transaction_message_ids.push_back(graphene::net::message(transaction_message).id());
-               }
+               // a trx_message packs as the signed_transaction alone, which is a prefix of the sealed bytes
+               for (const sealed_transaction& transaction : block.transactions())
+                  contained_transaction_message_ids.push_back(
+                        fc::ripemd160::hash(transaction.packed().data(), (uint32_t)transaction.signed_packed_size()));
+
+               // Now that we are in sync, push back the pending transactions saved on shutdown a
+               // batch per block, rather than all at once
+               if( _chain_db->saved_pending_transactions() > 0 )
+                  _chain_db->push_saved_pending_transactions( 1000 );
             }
 
             return result;
@@ -523,13 +569,13 @@ namespace detail {
          ++trx_count;
          auto now = fc::time_point::now();
          if( now - last_call > fc::seconds(1) ) {
-            ilog("Got ${c} transactions from network", ("c",trx_count) );
+            ilog("Got ${c} transactions from network, ${p} pending", ("c",trx_count)("p",_chain_db->get_pending_transaction_pool().size()) );
             last_call = now;
             trx_count = 0;
          }
 
          _chain_db->push_transaction( transaction_message.trx );
-      } FC_CAPTURE_AND_RETHROW( (transaction_message) ) }
+      } GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW( (transaction_message) ) }
 
       virtual void handle_message(const message& message_to_process) override
       {
@@ -911,6 +957,22 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("genesis-json", bpo::value<boost::filesystem::path>(), "File to read Genesis State from")
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file")
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
+         ("worker-threads", bpo::value<uint32_t>(), "Number of threads used for signature recovery on incoming blocks "
+                                                    "(defaults to one less than the number of CPU cores, 0 to disable)")
+         ("verified-transaction-cache-size", bpo::value<uint32_t>(), "Number of already verified transactions whose "
+                                                                     "signature keys are remembered (default 20000, 0 to disable)")
+         ("track-transaction-conflicts", "Log how many transactions of each applied block access objects written by earlier ones")
+         ("speculative-execution", "Check the transfers of each applied block on the worker pool before applying it in order")
+         ("profile-operations", "Record call counts and latencies of each operation's evaluator, logged on shutdown")
+         ("max-pending-transactions", bpo::value<uint32_t>(), "Maximum number of pending transactions kept for the next blocks; "
+                                                               "the lowest paying ones are evicted first (default 100000)")
+         ("max-pending-transactions-mb", bpo::value<uint32_t>(), "Maximum size in MiB of the pending transactions (default 64)")
+         ("max-pending-transactions-per-account", bpo::value<uint32_t>()->default_value(1000),
+          "Maximum number of pending transactions paid for by one account, 0 for no limit")
+         ("max-pending-transactions-kb-per-account", bpo::value<uint32_t>()->default_value(1024),
+          "Maximum size in KiB of the pending transactions paid for by one account, 0 for no limit")
+         ("pending-quota-exempt-account", bpo::value<vector<string>>()->composing()->multitoken(),
+          "ID of an account whose pending transactions are not limited (e.g. \"1.2.5\", quotes are required, may specify multiple times)")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
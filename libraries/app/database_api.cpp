@@ -72,6 +72,10 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       fc::variant_object get_config()const;
       chain_id_type get_chain_id()const;
       dynamic_global_property_object get_dynamic_global_properties()const;
+      verified_transaction_cache::stats get_verified_transaction_cache_stats()const;
+      authority_check_cache::stats get_authority_check_cache_stats()const;
+      vector<operation_profiler::operation_stats> get_operation_timing_stats()const;
+      pending_transaction_pool::stats get_pending_transaction_pool_stats()const;
 
       // Keys
       vector<vector<account_id_type>> get_key_references( vector<public_key_type> key )const;
@@ -170,6 +174,11 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void on_objects_removed(const vector<const object*>& objs);
       void on_applied_block();
 
+      /** connects to the database change signals only while something is subscribed,
+       * so idle API sessions do not make the database report every change
+       */
+      void update_change_connections();
+
       mutable fc::bloom_filter                               _subscribe_filter;
       std::function<void(const fc::variant&)> _subscribe_callback;
       std::function<void(const fc::variant&)> _pending_trx_callback;
@@ -197,12 +206,6 @@ database_api::~database_api() {}
 database_api_impl::database_api_impl( graphene::chain::database& db ):_db(db)
 {
    wlog("creating database api ${x}", ("x",int64_t(this)) );
-   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids) {
-                                on_objects_changed(ids);
-                                });
-   _removed_connection = _db.removed_objects.connect([this](const vector<const object*>& objs) {
-                                on_objects_removed(objs);
-                                });
    _applied_block_connection = _db.applied_block.connect([this](const signed_block&){ on_applied_block(); });
 
    _pending_trx_connection = _db.on_pending_transaction.connect([this](const signed_transaction& trx ){
@@ -279,6 +282,7 @@ void database_api_impl::set_subscribe_callback( std::function<void(const variant
       param.compute_optimal_parameters();
       _subscribe_filter = fc::bloom_filter(param);
    }
+   update_change_connections();
 }
 
 void database_api::set_pending_transaction_callback( std::function<void(const variant&)> cb )
@@ -310,6 +314,7 @@ void database_api_impl::cancel_all_subscriptions()
 {
    set_subscribe_callback( std::function<void(const fc::variant&)>(), true);
    _market_subscriptions.clear();
+   update_change_connections();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -419,6 +424,46 @@ dynamic_global_property_object database_api_impl::get_dynamic_global_properties(
    return _db.get(dynamic_global_property_id_type());
 }
 
+verified_transaction_cache::stats database_api::get_verified_transaction_cache_stats()const
+{
+   return my->get_verified_transaction_cache_stats();
+}
+
+verified_transaction_cache::stats database_api_impl::get_verified_transaction_cache_stats()const
+{
+   return _db.get_verified_transaction_cache().get_stats();
+}
+
+authority_check_cache::stats database_api::get_authority_check_cache_stats()const
+{
+   return my->get_authority_check_cache_stats();
+}
+
+authority_check_cache::stats database_api_impl::get_authority_check_cache_stats()const
+{
+   return _db.get_authority_check_cache().get_stats();
+}
+
+vector<operation_profiler::operation_stats> database_api::get_operation_timing_stats()const
+{
+   return my->get_operation_timing_stats();
+}
+
+vector<operation_profiler::operation_stats> database_api_impl::get_operation_timing_stats()const
+{
+   return _db.get_operation_profiler().get_stats();
+}
+
+pending_transaction_pool::stats database_api::get_pending_transaction_pool_stats()const
+{
+   return my->get_pending_transaction_pool_stats();
+}
+
+pending_transaction_pool::stats database_api_impl::get_pending_transaction_pool_stats()const
+{
+   return _db.get_pending_transaction_pool().get_stats();
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Keys                                                             //
@@ -984,6 +1029,7 @@ void database_api_impl::subscribe_to_market(std::function<void(const variant&)>
    if(a > b) std::swap(a,b);
    FC_ASSERT(a != b);
    _market_subscriptions[ std::make_pair(a,b) ] = callback;
+   update_change_connections();
 }
 
 void database_api::unsubscribe_from_market(asset_id_type a, asset_id_type b)
@@ -996,6 +1042,7 @@ void database_api_impl::unsubscribe_from_market(asset_id_type a, asset_id_type b
    if(a > b) std::swap(a,b);
    FC_ASSERT(a != b);
    _market_subscriptions.erase(std::make_pair(a,b));
+   update_change_connections();
 }
 
 market_ticker database_api::get_ticker( const string& base, const string& quote )const
@@ -1120,9 +1167,6 @@ order_book database_api::get_order_book( const string& base, const string& quote
 
 order_book database_api_impl::get_order_book( const string& base, const string& quote, unsigned limit )const
 {
-   using boost::multiprecision::uint128_t;
-   FC_ASSERT( limit <= 50 );
-
    order_book result;
    result.base = base;
    result.quote = quote;
@@ -1133,8 +1177,6 @@ order_book database_api_impl::get_order_book( const string& base, const string&
 
    auto base_id = assets[0]->id;
    auto quote_id = assets[1]->id;
-   auto orders = get_limit_orders( base_id, quote_id, limit );
-
 
    auto asset_to_real = [&]( const asset& a, int p ) { return double(a.amount.value)/pow( 10, p ); };
    auto price_to_real = [&]( const price& p )
@@ -1145,24 +1187,40 @@ order_book database_api_impl::get_order_book( const string& base, const string&
          return asset_to_real( p.quote, assets[0]->precision ) / asset_to_real( p.base, assets[1]->precision );
    };
 
-   for( const auto& o : orders )
+   // sums above the maximum supply only come from absurd prices, they are capped rather than wrapped
+   auto to_share = []( const fc::uint128& amount ) {
+      return share_type( int64_t( std::min( amount, fc::uint128( uint64_t( GRAPHENE_MAX_SHARE_SUPPLY ) ) ).to_uint64() ) );
+   };
+
+   const auto& levels = dynamic_cast< const primary_index< limit_order_index >& >(
+      _db.get_index_type< limit_order_index >() ).get_secondary_index< limit_order_price_level_index >();
+
+   auto bid_levels = levels.get_levels( base_id, quote_id );
+   for( auto itr = bid_levels.first; itr != bid_levels.second && result.bids.size() < limit; ++itr )
    {
-      if( o.sell_price.base.asset_id == base_id )
-      {
-         order ord;
-         ord.price = price_to_real( o.sell_price );
-         ord.quote = asset_to_real( share_type( ( uint128_t( o.for_sale.value ) * o.sell_price.quote.amount.value ) / o.sell_price.base.amount.value ), assets[1]->precision );
-         ord.base = asset_to_real( o.for_sale, assets[0]->precision );
-         result.bids.push_back( ord );
-      }
-      else
-      {
-         order ord;
-         ord.price = price_to_real( o.sell_price );
-         ord.quote = asset_to_real( o.for_sale, assets[1]->precision );
-         ord.base = asset_to_real( share_type( ( uint64_t( o.for_sale.value ) * o.sell_price.quote.amount.value ) / o.sell_price.base.amount.value ), assets[0]->precision );
-         result.asks.push_back( ord );
-      }
+      const auto& level = itr->second;
+      order ord;
+      ord.price = price_to_real( level.sell_price );
+      ord.base_amount = to_share( level.for_sale );
+      ord.quote_amount = to_share( level.to_receive );
+      ord.base = asset_to_real( ord.base_amount, assets[0]->precision );
+      ord.quote = asset_to_real( ord.quote_amount, assets[1]->precision );
+      ord.order_count = level.order_count;
+      result.bids.push_back( ord );
+   }
+
+   auto ask_levels = levels.get_levels( quote_id, base_id );
+   for( auto itr = ask_levels.first; itr != ask_levels.second && result.asks.size() < limit; ++itr )
+   {
+      const auto& level = itr->second;
+      order ord;
+      ord.price = price_to_real( level.sell_price );
+      ord.quote_amount = to_share( level.for_sale );
+      ord.base_amount = to_share( level.to_receive );
+      ord.base = asset_to_real( ord.base_amount, assets[0]->precision );
+      ord.quote = asset_to_real( ord.quote_amount, assets[1]->precision );
+      ord.order_count = level.order_count;
+      result.asks.push_back( ord );
    }
 
    return result;
@@ -1765,6 +1823,26 @@ void database_api_impl::broadcast_updates( const vector<variant>& updates )
    }
 }
 
+void database_api_impl::update_change_connections()
+{
+   if( _subscribe_callback || _market_subscriptions.size() )
+   {
+      if( !_change_connection.connected() )
+         _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids) {
+                                   on_objects_changed(ids);
+                                   });
+      if( !_removed_connection.connected() )
+         _removed_connection = _db.removed_objects.connect([this](const vector<const object*>& objs) {
+                                   on_objects_removed(objs);
+                                   });
+   }
+   else
+   {
+      _change_connection.disconnect();
+      _removed_connection.disconnect();
+   }
+}
+
 void database_api_impl::on_objects_removed( const vector<const object*>& objs )
 {
    /// we need to ensure the database_api is not deleted for the life of the async operation
@@ -1808,8 +1886,13 @@ void database_api_impl::on_objects_removed( const vector<const object*>& objs )
 
 void database_api_impl::on_objects_changed(const vector<object_id_type>& ids)
 {
-   vector<variant>    updates;
-   map< pair<asset_id_type, asset_id_type>,  vector<variant> > market_broadcast_queue;
+   if( !_subscribe_callback && _market_subscriptions.empty() )
+      return;
+
+   auto updates_ptr = std::make_shared< vector<variant> >();
+   auto queue_ptr = std::make_shared< map< pair<asset_id_type, asset_id_type>, vector<variant> > >();
+   vector<variant>& updates = *updates_ptr;
+   map< pair<asset_id_type, asset_id_type>,  vector<variant> >& market_broadcast_queue = *queue_ptr;
 
    for(auto id : ids)
    {
@@ -1844,15 +1927,19 @@ void database_api_impl::on_objects_changed(const vector<object_id_type>& ids)
       }
    }
 
+   if( updates.empty() && market_broadcast_queue.empty() )
+      return;
+
    auto capture_this = shared_from_this();
 
    /// pushing the future back / popping the prior future if it is complete.
    /// if a connection hangs then this could get backed up and result in
    /// a failure to exit cleanly.
-   fc::async([capture_this,this,updates,market_broadcast_queue](){
-      if( _subscribe_callback ) _subscribe_callback( updates );
+   /// the task shares the built updates rather than copying them.
+   fc::async([capture_this,this,updates_ptr,queue_ptr](){
+      if( _subscribe_callback ) _subscribe_callback( *updates_ptr );
 
-      for( const auto& item : market_broadcast_queue )
+      for( const auto& item : *queue_ptr )
       {
         auto sub = _market_subscriptions.find(item.first);
         if( sub != _market_subscriptions.end() )
@@ -32,6 +32,7 @@
 #include <graphene/market_history/market_history_plugin.hpp>
 
 #include <graphene/debug_witness/debug_api.hpp>
+#include <graphene/witness/witness_api.hpp>
 
 #include <graphene/net/node.hpp>
 
@@ -308,6 +309,8 @@ namespace graphene { namespace app {
          fc::api<music_contract_api> music_contract()const;
          /// @brief Retrieve the debug API (if available)
          fc::api<graphene::debug_witness::debug_api> debug()const;
+         /// @brief Retrieve the witness API (if available)
+         fc::api<graphene::witness_plugin::witness_api> witness()const;
 
       private:
          /// @brief Called to enable an API, not reflected.
@@ -321,6 +324,7 @@ namespace graphene { namespace app {
          optional< fc::api<crypto_api> > _crypto_api;
          optional< fc::api<music_contract_api> > _music_contract_api;
          optional< fc::api<graphene::debug_witness::debug_api> > _debug_api;
+         optional< fc::api<graphene::witness_plugin::witness_api> > _witness_api;
    };
 
 }}  // graphene::app
@@ -377,4 +381,5 @@ FC_API(graphene::app::login_api,
        (crypto)
        (music_contract)
        (debug)
+       (witness)
      )
@@ -64,11 +64,16 @@ using namespace std;
 
 class database_api_impl;
 
+/// a price level of the order book, the sum of the orders at that price
 struct order
 {
    double                     price;
    double                     quote;
    double                     base;
+   /// quote and base in satoshis, exact
+   share_type                 quote_amount;
+   share_type                 base_amount;
+   uint32_t                   order_count = 0;
 };
 
 struct order_book
@@ -206,6 +211,28 @@ class database_api
        */
       dynamic_global_property_object get_dynamic_global_properties()const;
 
+      /**
+       * @brief Retrieve hit and miss counts of the cache of already verified transactions
+       */
+      verified_transaction_cache::stats get_verified_transaction_cache_stats()const;
+
+      /**
+       * @brief Retrieve hit and miss counts of the cache of passed authority checks
+       */
+      authority_check_cache::stats get_authority_check_cache_stats()const;
+
+      /**
+       * @brief Retrieve call counts and latency histograms of the evaluator of each operation type
+       *
+       * Empty unless the node runs with --profile-operations.
+       */
+      vector<operation_profiler::operation_stats> get_operation_timing_stats()const;
+
+      /**
+       * @brief Retrieve the size, limits and admission counters of the pending transaction pool
+       */
+      pending_transaction_pool::stats get_pending_transaction_pool_stats()const;
+
       //////////
       // Keys //
       //////////
@@ -392,8 +419,8 @@ class database_api
        * @brief Returns the order book for the market base:quote
        * @param base String name of the first asset
        * @param quote String name of the second asset
-       * @param depth of the order book. Up to depth of each asks and bids, capped at 50. Prioritizes most moderate of each
-       * @return Order book of the market
+       * @param limit depth of the order book, the number of price levels of each of asks and bids. Prioritizes most moderate of each
+       * @return Order book of the market, one entry per price level
        */
       order_book get_order_book( const string& base, const string& quote, unsigned limit = 50 )const;
 
@@ -561,7 +588,7 @@ class database_api
 
 } }
 
-FC_REFLECT( graphene::app::order, (price)(quote)(base) );
+FC_REFLECT( graphene::app::order, (price)(quote)(base)(quote_amount)(base_amount)(order_count) );
 FC_REFLECT( graphene::app::order_book, (base)(quote)(bids)(asks) );
 FC_REFLECT( graphene::app::market_ticker, (base)(quote)(latest)(lowest_ask)(highest_bid)(percent_change)(base_volume)(quote_volume) );
 FC_REFLECT( graphene::app::market_volume, (base)(quote)(base_volume)(quote_volume) );
@@ -589,6 +616,10 @@ FC_API(graphene::app::database_api,
    (get_config)
    (get_chain_id)
    (get_dynamic_global_properties)
+   (get_verified_transaction_cache_stats)
+   (get_authority_check_cache_stats)
+   (get_operation_timing_stats)
+   (get_pending_transaction_pool_stats)
 
    // Keys
    (get_key_references)
@@ -27,6 +27,8 @@
 #include <graphene/chain/hardfork.hpp>
 #include <fc/uint128.hpp>
 
+#include <algorithm>
+
 namespace graphene { namespace chain {
 
 share_type cut_fee(share_type a, uint16_t p)
@@ -267,4 +269,68 @@ void account_referrer_index::object_modified( const object& after  )
 {
 }
 
+void balances_by_asset_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   _balances[b.asset_type].changed.insert( &b );
+}
+
+void balances_by_asset_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   auto& balances = _balances[b.asset_type];
+   balances.changed.erase( &b );
+   balances.removed.insert( &b );
+   // balances created and removed again by undo never reach sorted, keep them from piling up
+   if( balances.removed.size() > balances.sorted.size() )
+      merge_changes( balances );
+}
+
+void balances_by_asset_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const account_balance_object*>(&after) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(after);
+   _balances[b.asset_type].changed.insert( &b );
+}
+
+void balances_by_asset_index::merge_changes( asset_balances& balances )
+{
+   auto by_amount = []( const account_balance_object* a, const account_balance_object* b ) {
+      if( a->balance != b->balance )
+         return a->balance > b->balance;
+      return a->owner < b->owner;
+   };
+
+   // take the changed and removed balances out, the remaining ones are still in order
+   auto is_stale = [&]( const account_balance_object* b ) {
+      return balances.changed.count( b ) || balances.removed.count( b );
+   };
+   balances.sorted.erase( std::remove_if( balances.sorted.begin(), balances.sorted.end(), is_stale ), balances.sorted.end() );
+
+   size_t middle = balances.sorted.size();
+   balances.sorted.insert( balances.sorted.end(), balances.changed.begin(), balances.changed.end() );
+   std::sort( balances.sorted.begin() + middle, balances.sorted.end(), by_amount );
+   std::inplace_merge( balances.sorted.begin(), balances.sorted.begin() + middle, balances.sorted.end(), by_amount );
+   balances.changed.clear();
+   balances.removed.clear();
+}
+
+const vector<const account_balance_object*>& balances_by_asset_index::get_balances_by_amount( asset_id_type asset )const
+{
+   auto& balances = _balances[asset];
+   if( !balances.changed.empty() || !balances.removed.empty() )
+      merge_changes( balances );
+   return balances.sorted;
+}
+
+size_t balances_by_asset_index::pending_changes( asset_id_type asset )const
+{
+   auto itr = _balances.find( asset );
+   if( itr == _balances.end() )
+      return 0;
+   return itr->second.changed.size() + itr->second.removed.size();
+}
+
 } } // graphene::chain
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/authority_check_cache.hpp>
+
+#include <fc/io/raw.hpp>
+
+namespace graphene { namespace chain {
+
+void authority_check_cache::verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                                              const std::function<const authority*(account_id_type)>& get_active,
+                                              const std::function<const authority*(account_id_type)>& get_owner,
+                                              uint32_t max_recursion )
+{
+   flat_set<account_id_type> required_active;
+   flat_set<account_id_type> required_owner;
+   vector<authority> other;
+   for( const auto& op : ops )
+      operation_get_required_authorities( op, required_active, required_owner, other );
+
+   digest_type::encoder enc;
+   fc::raw::pack( enc, required_active );
+   fc::raw::pack( enc, required_owner );
+   fc::raw::pack( enc, other );
+   fc::raw::pack( enc, sigs );
+   fc::raw::pack( enc, max_recursion );
+   digest_type key = enc.result();
+
+   if( _passed.find( key ) != _passed.end() )
+   {
+      ++_stats.hits;
+      return;
+   }
+   ++_stats.misses;
+
+   graphene::chain::verify_authority( ops, sigs, get_active, get_owner, max_recursion );
+   _passed.insert( key );
+}
+
+authority_check_cache::stats authority_check_cache::get_stats()const
+{
+   stats result = _stats;
+   result.size = _passed.size();
+   return result;
+}
+
+} } // graphene::chain
@@ -23,6 +23,7 @@
  */
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/exceptions.hpp>
 
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
@@ -34,10 +35,11 @@ namespace graphene { namespace chain {
 
 asset database::get_balance(account_id_type owner, asset_id_type asset_id) const
 {
-   auto& index = get_index_type<account_balance_index>().indices().get<by_account_asset>();
+   auto& index = get_index_type<account_balance_index>().indices().get<by_account_asset_hash>();
    auto itr = index.find(boost::make_tuple(owner, asset_id));
    if( itr == index.end() )
       return asset(0, asset_id);
+   note_read( itr->id );
    return itr->get_balance();
 }
 
@@ -56,14 +58,14 @@ void database::adjust_balance(account_id_type account, asset delta )
    if( delta.amount == 0 )
       return;
 
-   auto& index = get_index_type<account_balance_index>().indices().get<by_account_asset>();
+   auto& index = get_index_type<account_balance_index>().indices().get<by_account_asset_hash>();
    auto itr = index.find(boost::make_tuple(account, delta.asset_id));
    if(itr == index.end())
    {
-      FC_ASSERT( delta.amount > 0, "Insufficient Balance: ${a}'s balance of ${b} is less than required ${r}", 
-                 ("a",account(*this).name)
-                 ("b",to_pretty_string(asset(0,delta.asset_id)))
-                 ("r",to_pretty_string(-delta)));
+      GRAPHENE_ASSERT( delta.amount > 0, insufficient_funds, "Insufficient Balance: ${a}'s balance of ${b} is less than required ${r}", 
+                       ("a",account)
+                       ("b",asset(0,delta.asset_id))
+                       ("r",-delta));
       create<account_balance_object>([account,&delta](account_balance_object& b) {
          b.owner = account;
          b.asset_type = delta.asset_id;
@@ -71,13 +73,13 @@ void database::adjust_balance(account_id_type account, asset delta )
       });
    } else {
       if( delta.amount < 0 )
-         FC_ASSERT( itr->get_balance() >= -delta, "Insufficient Balance: ${a}'s balance of ${b} is less than required ${r}", ("a",account(*this).name)("b",to_pretty_string(itr->get_balance()))("r",to_pretty_string(-delta)));
+         GRAPHENE_ASSERT( itr->get_balance() >= -delta, insufficient_funds, "Insufficient Balance: ${a}'s balance of ${b} is less than required ${r}", ("a",account)("b",itr->get_balance())("r",-delta));
       modify(*itr, [delta](account_balance_object& b) {
          b.adjust_balance(delta);
       });
    }
 
-} FC_CAPTURE_AND_RETHROW( (account)(delta) ) }
+} GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW( (account)(delta) ) }
 
 optional< vesting_balance_id_type > database::deposit_lazy_vesting(
    const optional< vesting_balance_id_type >& ovbid,
@@ -35,11 +35,58 @@
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/thread_pool.hpp>
 
 #include <fc/smart_ref_impl.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace graphene { namespace chain {
 
+namespace {
+   /// finds the transactions of a block that access objects written by earlier ones
+   class conflict_analyzer
+   {
+      public:
+         explicit conflict_analyzer( uint32_t block_num ) { _stats.block_num = block_num; }
+
+         void add_transaction( const object_access_set& access )
+         {
+            // new objects get their ids in commit order, only later accesses to them conflict
+            uint32_t round = 1;
+            auto check = [&]( const object_id_type& id ) {
+               auto itr = _write_rounds.find( id );
+               if( itr != _write_rounds.end() )
+                  round = std::max( round, itr->second + 1 );
+            };
+            for( const auto& id : access.reads )
+               check( id );
+            for( const auto& id : access.writes )
+               check( id );
+            for( const auto& id : access.writes )
+            {
+               auto& r = _write_rounds[id];
+               r = std::max( r, round );
+            }
+
+            ++_stats.transactions;
+            if( round > 1 )
+               ++_stats.conflicting;
+            _stats.rounds = std::max( _stats.rounds, round );
+         }
+
+         const transaction_conflict_stats& stats()const { return _stats; }
+
+      private:
+         transaction_conflict_stats                       _stats;
+         std::unordered_map<object_id_type, uint32_t>      _write_rounds;
+   };
+}
+
 bool database::is_known_block( const block_id_type& id )const
 {
    return _fork_db.is_known_block(id) || _block_id_to_block.contains(id);
@@ -78,12 +125,27 @@ optional<signed_block> database::fetch_block_by_number( uint32_t num )const
    return optional<signed_block>();
 }
 
-const signed_transaction& database::get_recent_transaction(const transaction_id_type& trx_id) const
+signed_transaction database::get_recent_transaction(const transaction_id_type& trx_id) const
 {
    auto& index = get_index_type<transaction_index>().indices().get<by_trx_id>();
    auto itr = index.find(trx_id);
    FC_ASSERT(itr != index.end());
-   return itr->trx;
+
+   auto cached = _recent_trx_cache.find( trx_id );
+   if( cached.valid() )
+      return *cached;
+
+   auto pending = _pending_pool.find( trx_id );
+   if( pending.valid() )
+      return pending->get();
+
+   auto block = fetch_block_by_number( itr->block_num );
+   if( block.valid() )
+      for( const auto& trx : block->transactions )
+         if( trx.id() == trx_id )
+            return trx;
+   FC_THROW_EXCEPTION( fc::key_not_found_exception, "Transaction ${id} is not in block ${n}",
+                       ("id", trx_id)("n", itr->block_num) );
 }
 
 std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of_fork) const
@@ -111,21 +173,36 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
  * @return true if we switched forks as a result of this push.
  */
 bool database::push_block(const signed_block& new_block, uint32_t skip)
+{
+   return push_block( seal_block( new_block ), skip );
+}
+
+bool database::push_block(const sealed_block& new_block, uint32_t skip)
 {
    //idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
    bool result;
+   fc::time_point applied;
+   _precomputed_checks = precompute_block_checks( new_block, skip );
    detail::with_skip_flags( *this, skip, [&]()
    {
-      detail::without_pending_transactions( *this, std::move(_pending_tx),
+      detail::without_pending_transactions( *this, _pending_pool.take_all(),
       [&]()
       {
          result = _push_block(new_block);
+         applied = fc::time_point::now();
       });
    });
+   _precomputed_checks.reset();
+   _last_pending_restore_time = fc::time_point::now() - applied;
    return result;
 }
 
 bool database::_push_block(const signed_block& new_block)
+{
+   return _push_block( seal_block( new_block ) );
+}
+
+bool database::_push_block(const sealed_block& new_block)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
    if( !(skip&skip_fork_db) )
@@ -195,7 +272,7 @@ bool database::_push_block(const signed_block& new_block)
    try {
       auto session = _undo_db.start_undo_session();
       apply_block(new_block, skip);
-      _block_id_to_block.store(new_block.id(), new_block);
+      _block_id_to_block.store(new_block.id(), new_block.get());
       session.commit();
    } catch ( const fc::exception& e ) {
       elog("Failed to push new block:\n${e}", ("e", e.to_detail_string()));
@@ -204,7 +281,7 @@ bool database::_push_block(const signed_block& new_block)
    }
 
    return false;
-} FC_CAPTURE_AND_RETHROW( (new_block) ) }
+} FC_CAPTURE_AND_RETHROW( (new_block.get()) ) }
 
 /**
  * Attempts to push the transaction into the pending queue
@@ -223,10 +300,51 @@ processed_transaction database::push_transaction( const signed_transaction& trx,
       result = _push_transaction( trx );
    } );
    return result;
-} FC_CAPTURE_AND_RETHROW( (trx) ) }
+} GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW( (trx) ) }
 
-processed_transaction database::_push_transaction( const signed_transaction& trx )
+processed_transaction database::_push_transaction( const signed_transaction& trx, bool readmit )
 {
+   return _push_transaction( sealed_transaction( trx, get_chain_id() ), readmit );
+}
+
+/// core asset value of the fees a transaction offers, which ranks it in the pending pool
+static share_type core_fee_value( const database& db, const signed_transaction& trx )
+{
+   share_type total = 0;
+   for( const auto& op : trx.operations )
+   {
+      asset fee = operation_get_fee( op );
+      if( fee.amount <= 0 )
+         continue;
+      if( fee.asset_id == asset_id_type() )
+         total += fee.amount;
+      else if( const asset_object* fee_asset = db.find( fee.asset_id ) )
+         total += ( fee * fee_asset->options.core_exchange_rate ).amount;
+   }
+   return total;
+}
+
+processed_transaction database::_push_transaction( const sealed_transaction& trx, bool readmit )
+{
+   // Drop what expired since the last push, then refuse a transaction whose fee payer is
+   // over its quota or which would not earn a place in a full pool before spending any time
+   // applying it.  Transactions taken back from the pool or from popped blocks were admitted
+   // before and are not refused again, the pool evicts its lowest paying entries once they are
+   // all back.
+   _pending_pool.remove_expired( head_block_time() );
+   const signed_transaction& strx = trx.get();
+   account_id_type fee_payer = strx.operations.empty() ? account_id_type()
+                                                       : operation_get_fee_payer( strx.operations.front() );
+   GRAPHENE_ASSERT( readmit || _pending_pool.within_fee_payer_quota( fee_payer, trx.packed_size() ),
+                    pending_fee_payer_quota, "Account ${a} has too many pending transactions to add ${id}",
+                    ("a", fee_payer)("id", trx.id()) );
+   share_type core_fee = core_fee_value( *this, strx );
+   GRAPHENE_ASSERT( readmit
+                    || _pending_pool.can_admit( pending_transaction_pool::fee_density( core_fee, trx.packed_size() ),
+                                                trx.packed_size() ),
+                    pending_pool_full, "Pending transaction pool is full, transaction ${id} does not pay enough to enter it",
+                    ("id", trx.id()) );
+
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
    if( !_pending_tx_session.valid() )
@@ -238,18 +356,75 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    // apply the changes.
 
    auto temp_session = _undo_db.start_undo_session();
-   auto processed_trx = _apply_transaction( trx );
-   _pending_tx.push_back(processed_trx);
+   std::shared_ptr<const vector<object_id_type>> accessed;
+   auto processed_trx = _apply_tracked_transaction( trx, nullptr, accessed );
+   _pending_pool.add( trx, fee_payer, core_fee, std::move(accessed) );
 
    notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
    temp_session.merge();
+   _extend_block_candidate( processed_trx );
 
    // notify anyone listening to pending transactions
-   on_pending_transaction( trx );
+   on_pending_transaction( trx.get() );
    return processed_trx;
 }
 
+void database::_carry_over_pending_transaction( pending_transaction_pool::entry e )
+{
+   if( !_pending_tx_session.valid() )
+      _pending_tx_session = _undo_db.start_undo_session();
+
+   auto temp_session = _undo_db.start_undo_session();
+   // The transaction passed validate() and its signatures, authorities and TaPoS were checked
+   // against objects the new block did not change; only its operations need to run again
+   precomputed_transaction_checks checks;
+   checks.validated = true;
+   uint32_t skip = get_node_properties().skip_flags | skip_transaction_signatures | skip_authority_check
+                 | skip_tapos_check;
+   detail::with_skip_flags( *this, skip, [&]()
+   {
+      _apply_tracked_transaction( e.trx, &checks, e.accessed_objects );
+   });
+   _pending_pool.carry_over( std::move(e) );
+
+   notify_changed_objects();
+   temp_session.merge();
+}
+
+optional< vector<object_id_type> > database::_objects_changed_since( const block_id_type& previous_head )const
+{
+   if( head_block_id() == previous_head )
+      return vector<object_id_type>();
+   if( !_undo_db.enabled() || _undo_db.size() == 0 )
+      return optional< vector<object_id_type> >();
+   auto head = _fork_db.fetch_block( head_block_id() );
+   if( !head || head->previous_id() != previous_head )
+      return optional< vector<object_id_type> >();
+
+   // Objects created by the block did not exist when the pending transactions were applied,
+   // so only the objects it modified or removed can invalidate their checks
+   const undo_state& state = _undo_db.head();
+   vector<object_id_type> changed;
+   changed.reserve( state.old_values.size() + state.removed.size() );
+   for( const auto& item : state.old_values )
+      changed.push_back( item.first );
+   for( const auto& item : state.removed )
+      changed.push_back( item.first );
+
+   // Authority checks read accounts through the authority cache and follow account authorities
+   // to any depth, so the objects a transaction accessed do not cover every account they depend on
+   for( const object_id_type& id : changed )
+      if( id.is<account_id_type>() || id.is<global_property_id_type>() )
+         return optional< vector<object_id_type> >();
+
+   // The head block time is compared to the expiration of every transaction separately
+   changed.erase( std::remove( changed.begin(), changed.end(), object_id_type( dynamic_global_property_id_type() ) ),
+                  changed.end() );
+   std::sort( changed.begin(), changed.end() );
+   return changed;
+}
+
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
    auto session = _undo_db.start_undo_session();
@@ -308,29 +483,23 @@ signed_block database::generate_block(
    return result;
 } FC_CAPTURE_AND_RETHROW() }
 
-signed_block database::_generate_block(
-   fc::time_point_sec when,
-   witness_id_type witness_id,
-   const fc::ecc::private_key& block_signing_private_key
-   )
-{
-   try {
-   uint32_t skip = get_node_properties().skip_flags;
-   uint32_t slot_num = get_slot_at_time( when );
-   FC_ASSERT( slot_num > 0 );
-   witness_id_type scheduled_witness = get_scheduled_witness( slot_num );
-   FC_ASSERT( scheduled_witness == witness_id );
-
-   const auto& witness_obj = witness_id(*this);
-
-   if( !(skip & skip_witness_signature) )
-      FC_ASSERT( witness_obj.signing_key == block_signing_private_key.get_public_key() );
+uint32_t database::prepare_block_candidate( uint32_t skip )
+{ try {
+   detail::with_skip_flags( *this, skip, [&]()
+   {
+      _build_block_candidate( true );
+   } );
+   return _block_candidate->transactions.size();
+} FC_CAPTURE_AND_RETHROW() }
 
+void database::_build_block_candidate( bool keep_pending_state )
+{
    static const size_t max_block_header_size = fc::raw::pack_size( signed_block_header() ) + 4;
    auto maximum_block_size = get_global_properties().parameters.maximum_block_size;
-   size_t total_block_size = max_block_header_size;
 
-   signed_block pending_block;
+   block_candidate candidate;
+   candidate.previous = head_block_id();
+   candidate.total_size = max_block_header_size;
 
    //
    // The following code throws away existing pending_tx_session and
@@ -343,69 +512,182 @@ signed_block database::_generate_block(
    // the value of the "when" variable is known, which means we need to
    // re-apply pending transactions in this method.
    //
+   _block_candidate.reset();
    _pending_tx_session.reset();
    _pending_tx_session = _undo_db.start_undo_session();
 
+   _pending_pool.remove_expired( head_block_time() );
+
    uint64_t postponed_tx_count = 0;
-   // pop pending state (reset to head block state)
-   for( const processed_transaction& tx : _pending_tx )
+   // transactions dropped from the block, counted by the reason they failed
+   flat_map<string, uint32_t> rejected_tx_counts;
+   // pool entries which were applied to the candidate or failed
+   std::unordered_set<transaction_id_type> visited;
+   // Fill the block with the best paying transactions first, keeping the transactions of each
+   // fee payer in the order they arrived in
+   _pending_pool.for_each_by_value( [&]( const pending_transaction_pool::entry& entry )
    {
-      size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+      const sealed_transaction& tx = entry.trx;
+      size_t new_total_size = candidate.total_size + entry.size;
 
-      // postpone transaction if it would make block too big
+      // postpone transaction if it would make block too big, along with the later
+      // transactions of its fee payer
       if( new_total_size >= maximum_block_size )
       {
          postponed_tx_count++;
-         continue;
+         return false;
       }
 
       try
       {
          auto temp_session = _undo_db.start_undo_session();
-         processed_transaction ptx = _apply_transaction( tx );
+         sealed_transaction ptx( _apply_transaction( tx ), get_chain_id() );
+         visited.insert( tx.id() );
+
+         // The size of ptx may be different than the size of tx (i.e. if one or more
+         // results increased their size), postpone it if it no longer fits
+         if( candidate.total_size + ptx.packed_size() >= maximum_block_size )
+         {
+            postponed_tx_count++;
+            return false;
+         }
          temp_session.merge();
 
-         // We have to recompute pack_size(ptx) because it may be different
-         // than pack_size(tx) (i.e. if one or more results increased
-         // their size)
-         total_block_size += fc::raw::pack_size( ptx );
-         pending_block.transactions.push_back( ptx );
+         candidate.total_size += ptx.packed_size();
+         candidate.transactions.push_back( std::move(ptx) );
       }
       catch ( const fc::exception& e )
       {
-         // Do nothing, transaction will not be re-applied
-         wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
-         wlog( "The transaction was ${t}", ("t", tx) );
+         // Do nothing, transaction will not be re-applied.  Under a flood of invalid
+         // transactions formatting each failure dominates the cost of producing the
+         // block, so only the reasons are counted and summarized below.
+         visited.insert( tx.id() );
+         ++rejected_tx_counts[ e.name() ];
+         dlog( "Transaction ${id} was not processed while generating block due to ${e}",
+               ("id", tx.id())("e", e.to_string()) );
       }
-   }
+      return true;
+   } );
    if( postponed_tx_count > 0 )
    {
       wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
+      // the block is full, transactions pushed before the slot wait for the next one
+      candidate.closed = true;
+   }
+   if( rejected_tx_counts.size() )
+   {
+      wlog( "Dropped transactions that failed while generating block: ${r}", ("r", rejected_tx_counts) );
+   }
+
+   // Apply the postponed transactions on top of the candidate, so that the pending state still
+   // reflects the whole pool while the candidate waits for its slot.  The candidate is closed
+   // then, transactions pushed later are applied after these and cannot be appended to it.
+   // A candidate built at the slot is turned into a block right away, which discards the
+   // pending state, so this pass is skipped there.
+   if( keep_pending_state )
+   {
+      for( const auto& entry : _pending_pool.entries() )
+      {
+         if( visited.find( entry.id() ) != visited.end() )
+            continue;
+         try
+         {
+            auto temp_session = _undo_db.start_undo_session();
+            _apply_transaction( entry.trx );
+            temp_session.merge();
+         }
+         catch( const fc::exception& e )
+         {
+            dlog( "Postponed transaction ${id} was not applied after the block candidate due to ${e}",
+                  ("id", entry.id())("e", e.to_string()) );
+         }
+      }
+   }
+
+   _block_candidate = std::move( candidate );
+}
+
+void database::_extend_block_candidate( const processed_transaction& ptrx )
+{
+   if( !_block_candidate.valid() || _block_candidate->closed )
+      return;
+   sealed_transaction ptx( ptrx, get_chain_id() );
+   // Stop at the first transaction which does not fit: the later ones were applied on top of it
+   if( _block_candidate->total_size + ptx.packed_size() >= get_global_properties().parameters.maximum_block_size )
+   {
+      _block_candidate->closed = true;
+      return;
    }
+   _block_candidate->total_size += ptx.packed_size();
+   _block_candidate->transactions.push_back( std::move(ptx) );
+}
+
+signed_block database::_generate_block(
+   fc::time_point_sec when,
+   witness_id_type witness_id,
+   const fc::ecc::private_key& block_signing_private_key
+   )
+{
+   try {
+   fc::time_point start = fc::time_point::now();
+   block_generation_timings timings;
+   uint32_t skip = get_node_properties().skip_flags;
+   uint32_t slot_num = get_slot_at_time( when );
+   FC_ASSERT( slot_num > 0 );
+   witness_id_type scheduled_witness = get_scheduled_witness( slot_num );
+   FC_ASSERT( scheduled_witness == witness_id );
+
+   const auto& witness_obj = witness_id(*this);
 
+   if( !(skip & skip_witness_signature) )
+      FC_ASSERT( witness_obj.signing_key == block_signing_private_key.get_public_key() );
+
+   // A candidate prepared on top of the head block only needs its header
+   timings.preassembled = _block_candidate.valid() && _block_candidate->previous == head_block_id();
+   if( !timings.preassembled )
+      _build_block_candidate( false );
+   fc::time_point assembled = fc::time_point::now();
+   timings.assemble_us = timings.preassembled ? 0 : (assembled - start).count();
+   vector<sealed_transaction> sealed_transactions = std::move( _block_candidate->transactions );
+   _block_candidate.reset();
    _pending_tx_session.reset();
 
-   // We have temporarily broken the invariant that
-   // _pending_tx_session is the result of applying _pending_tx, as
-   // _pending_tx now consists of the set of postponed transactions.
-   // However, the push_block() call below will re-create the
-   // _pending_tx_session.
+   signed_block pending_block;
+   pending_block.transactions.reserve( sealed_transactions.size() );
+   for( const auto& ptx : sealed_transactions )
+      pending_block.transactions.push_back( ptx.get() );
 
    pending_block.previous = head_block_id();
    pending_block.timestamp = when;
-   pending_block.transaction_merkle_root = pending_block.calculate_merkle_root();
+   vector<digest_type> merkle_leaves;
+   merkle_leaves.reserve( sealed_transactions.size() );
+   for( const auto& ptx : sealed_transactions )
+      merkle_leaves.push_back( ptx.merkle_digest() );
+   pending_block.transaction_merkle_root = signed_block::calculate_merkle_root( std::move(merkle_leaves), get_worker_for_each() );
    pending_block.witness = witness_id;
 
    if( !(skip & skip_witness_signature) )
       pending_block.sign( block_signing_private_key );
+   fc::time_point signed_at = fc::time_point::now();
+   timings.sign_us = (signed_at - assembled).count();
+
+   sealed_block sealed( pending_block, std::move(sealed_transactions) );
 
    // TODO:  Move this to _push_block() so session is restored.
    if( !(skip & skip_block_size_check) )
    {
-      FC_ASSERT( fc::raw::pack_size(pending_block) <= get_global_properties().parameters.maximum_block_size );
+      FC_ASSERT( sealed.packed_size() <= get_global_properties().parameters.maximum_block_size );
    }
 
-   push_block( pending_block, skip );
+   push_block( sealed, skip );
+
+   fc::time_point pushed = fc::time_point::now();
+   timings.block_num = pending_block.block_num();
+   timings.transactions = pending_block.transactions.size();
+   timings.restore_pending_us = _last_pending_restore_time.count();
+   timings.apply_us = (pushed - signed_at).count() - timings.restore_pending_us;
+   timings.total_us = (pushed - start).count();
+   _last_generation_timings = timings;
 
    return pending_block;
 } FC_CAPTURE_AND_RETHROW( (witness_id) ) }
@@ -416,6 +698,7 @@ signed_block database::_generate_block(
  */
 void database::pop_block()
 { try {
+   _block_candidate.reset();
    _pending_tx_session.reset();
    auto head_id = head_block_id();
    optional<signed_block> head_block = fetch_block_by_id( head_id );
@@ -429,10 +712,96 @@ void database::pop_block()
 
 } FC_CAPTURE_AND_RETHROW() }
 
+precomputed_block_checks database::precompute_block_checks( const sealed_block& b, uint32_t skip )const
+{
+   precomputed_block_checks result;
+   result.block_id = b.id();
+   result.transactions.resize( b.transactions().size() );
+
+   bool recover_signee = !(skip & skip_witness_signature);
+   bool recover_trx_keys = !(skip & (skip_transaction_signatures | skip_authority_check));
+
+   // item 0 is the block header, item i+1 is transaction i
+   get_thread_pool().parallel_for( b.transactions().size() + 1, [&]( size_t i )
+   {
+      if( i == 0 )
+      {
+         if( recover_signee )
+         {
+            try {
+               result.signee = public_key_type( b.signee() );
+            } catch( const fc::exception& ) {
+               // left unset, the serial check will throw the same error
+            }
+         }
+         return;
+      }
+
+      const sealed_transaction& trx = b.transactions()[i-1];
+      precomputed_transaction_checks& checks = result.transactions[i-1];
+      if( recover_trx_keys )
+      {
+         // only transactions that passed validate() are cached
+         checks.signature_keys = _verified_trx_cache.find( trx.sig_digest(), trx.get().signatures );
+         checks.cache_checked = true;
+         if( checks.signature_keys.valid() )
+         {
+            checks.validated = true;
+            checks.cache_hit = true;
+            return;
+         }
+      }
+      try {
+         trx.get().validate();
+         checks.validated = true;
+         if( recover_trx_keys )
+            checks.signature_keys = trx.get_signature_keys();
+      } catch( const fc::exception& ) {
+         // left unset, the serial check will throw the same error
+      }
+   } );
+   return result;
+}
+
+sealed_block database::seal_block( const signed_block& b )const
+{
+   return sealed_block( b, get_chain_id(), get_worker_for_each() );
+}
+
+for_each_index_type database::get_worker_for_each()const
+{
+   thread_pool* pool = &get_thread_pool();
+   return [pool]( size_t count, const std::function<void(size_t)>& f )
+   {
+      pool->parallel_for( count, f );
+   };
+}
+
+void database::set_worker_thread_count( uint32_t thread_count )
+{
+   _worker_thread_count = thread_count;
+   _thread_pool.reset();
+}
+
+thread_pool& database::get_thread_pool()const
+{
+   if( !_thread_pool )
+   {
+      uint32_t thread_count;
+      if( _worker_thread_count.valid() )
+         thread_count = *_worker_thread_count;
+      else
+         thread_count = std::max( std::thread::hardware_concurrency(), 1u ) - 1;
+      _thread_pool.reset( new thread_pool( thread_count ) );
+   }
+   return *_thread_pool;
+}
+
 void database::clear_pending()
 { try {
-   assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
-   _pending_tx.clear();
+   assert( _pending_pool.empty() || _pending_tx_session.valid() );
+   _pending_pool.clear();
+   _block_candidate.reset();
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -465,6 +834,11 @@ const vector<optional< operation_history_object > >& database::get_applied_opera
 //////////////////// private methods ////////////////////
 
 void database::apply_block( const signed_block& next_block, uint32_t skip )
+{
+   apply_block( seal_block( next_block ), skip );
+}
+
+void database::apply_block( const sealed_block& next_block, uint32_t skip )
 {
    auto block_num = next_block.block_num();
    if( _checkpoints.size() && _checkpoints.rbegin()->second != block_id_type() )
@@ -484,15 +858,24 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
    return;
 }
 
-void database::_apply_block( const signed_block& next_block )
-{ try {
+void database::_apply_block( const sealed_block& sealed )
+{
+   const signed_block& next_block = sealed.get();
+   try {
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = get_node_properties().skip_flags;
    _applied_ops.clear();
+   _authority_cache->clear();
 
-   FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
+   FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == sealed.calculate_merkle_root( get_worker_for_each() ), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",sealed.calculate_merkle_root())("next_block",next_block)("id",sealed.id()) );
+
+   precomputed_block_checks precomputed;
+   if( _precomputed_checks.valid() && _precomputed_checks->block_id == sealed.id() )
+      precomputed = std::move( *_precomputed_checks );
+   else
+      precomputed = precompute_block_checks( sealed, skip );
 
-   const witness_object& signing_witness = validate_block_header(skip, next_block);
+   const witness_object& signing_witness = validate_block_header(skip, next_block, precomputed.signee);
    const auto& global_props = get_global_properties();
    const auto& dynamic_global_props = get<dynamic_global_property_object>(dynamic_global_property_id_type());
    bool maint_needed = (dynamic_global_props.next_maintenance_time <= next_block.timestamp);
@@ -500,7 +883,21 @@ void database::_apply_block( const signed_block& next_block )
    _current_block_num    = next_block_num;
    _current_trx_in_block = 0;
 
-   for( const auto& trx : next_block.transactions )
+   optional<conflict_analyzer> conflicts;
+   if( _track_transaction_conflicts )
+      conflicts = conflict_analyzer( next_block_num );
+
+   bool speculate = _speculative_execution && !next_block.transactions.empty();
+   std::unordered_set<object_id_type> block_writes;
+   if( speculate )
+   {
+      _last_block_speculation_stats = speculative_execution_stats();
+      _last_block_speculation_stats.block_num = next_block_num;
+      _speculate_operations( sealed, precomputed );
+      _speculation_block_writes = &block_writes;
+   }
+
+   for( uint32_t i = 0; i < next_block.transactions.size(); ++i )
    {
       /* We do not need to push the undo state for each transaction
        * because they either all apply and are valid or the
@@ -508,11 +905,39 @@ void database::_apply_block( const signed_block& next_block )
        * for transactions when validating broadcast transactions or
        * when building a block.
        */
-      apply_transaction( trx, skip );
+      if( conflicts.valid() || speculate )
+      {
+         object_access_set access;
+         set_access_tracker( &access );
+         try {
+            _apply_transaction( sealed.transactions()[i], &precomputed.transactions[i] );
+         } catch( ... ) {
+            set_access_tracker( nullptr );
+            _speculation_block_writes = nullptr;
+            throw;
+         }
+         set_access_tracker( nullptr );
+         if( conflicts.valid() )
+            conflicts->add_transaction( access );
+         if( speculate )
+            block_writes.insert( access.writes.begin(), access.writes.end() );
+      }
+      else
+         _apply_transaction( sealed.transactions()[i], &precomputed.transactions[i] );
       ++_current_trx_in_block;
    }
+   _speculation_block_writes = nullptr;
+
+   if( conflicts.valid() )
+   {
+      _last_block_conflict_stats = conflicts->stats();
+      if( _last_block_conflict_stats.transactions > 0 )
+         ilog( "Block ${n}: ${c} of ${t} transactions conflict, ${r} rounds of parallel execution",
+               ("n", next_block_num)("c", _last_block_conflict_stats.conflicting)
+               ("t", _last_block_conflict_stats.transactions)("r", _last_block_conflict_stats.rounds) );
+   }
 
-   update_global_dynamic_data(next_block);
+   update_global_dynamic_data(sealed);
    update_signing_witness(signing_witness, next_block);
    update_last_irreversible_block();
 
@@ -520,7 +945,7 @@ void database::_apply_block( const signed_block& next_block )
    if( maint_needed )
       perform_chain_maintenance(next_block, global_props);
 
-   create_block_summary(next_block);
+   create_block_summary(sealed);
    clear_expired_transactions();
    clear_expired_proposals();
    clear_expired_orders();
@@ -538,29 +963,60 @@ void database::_apply_block( const signed_block& next_block )
       apply_debug_updates();
 
    // notify observers that the block has been applied
-   applied_block( next_block ); //emit
+   _applying_block = &sealed;
+   try {
+      applied_block( next_block ); //emit
+   } catch( ... ) {
+      _applying_block = nullptr;
+      throw;
+   }
+   _applying_block = nullptr;
    _applied_ops.clear();
 
    notify_changed_objects();
+   notify_block_changed_objects();
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  }
 
 void database::notify_changed_objects()
 { try {
-   if( _undo_db.enabled() ) 
-   {
-      const auto& head_undo = _undo_db.head();
-      vector<object_id_type> changed_ids;  changed_ids.reserve(head_undo.old_values.size());
-      for( const auto& item : head_undo.old_values ) changed_ids.push_back(item.first);
-      for( const auto& item : head_undo.new_ids ) changed_ids.push_back(item);
-      vector<const object*> removed;
-      removed.reserve( head_undo.removed.size() );
-      for( const auto& item : head_undo.removed )
-      {
-         changed_ids.push_back( item.first );
-         removed.emplace_back( item.second.get() );
-      }
+   if( !_undo_db.enabled() )
+      return;
+
+   const bool per_notification = !changed_objects.empty();
+   const bool per_block = !changed_objects_by_block.empty();
+   // ids collected for the block are only dropped once nobody listens for them
+   if( !per_block )
+      _block_changed_ids.clear();
+   // nobody is listening, so there is no reason to walk the undo state
+   if( !per_notification && !per_block )
+      return;
+
+   const auto& head_undo = _undo_db.head();
+   vector<object_id_type> changed_ids;
+   changed_ids.reserve( head_undo.old_values.size() + head_undo.new_ids.size() + head_undo.removed.size() );
+   for( const auto& item : head_undo.old_values ) changed_ids.push_back(item.first);
+   for( const auto& item : head_undo.new_ids ) changed_ids.push_back(item);
+   for( const auto& item : head_undo.removed ) changed_ids.push_back(item.first);
+
+   if( per_block )
+      _block_changed_ids.insert( _block_changed_ids.end(), changed_ids.begin(), changed_ids.end() );
+   if( per_notification )
       changed_objects(changed_ids);
+} FC_CAPTURE_AND_RETHROW() }
+
+void database::notify_block_changed_objects()
+{ try {
+   if( changed_objects_by_block.empty() )
+   {
+      _block_changed_ids.clear();
+      return;
    }
+
+   std::sort( _block_changed_ids.begin(), _block_changed_ids.end() );
+   _block_changed_ids.erase( std::unique( _block_changed_ids.begin(), _block_changed_ids.end() ), _block_changed_ids.end() );
+   auto snapshot = std::make_shared<const vector<object_id_type>>( std::move( _block_changed_ids ) );
+   _block_changed_ids = vector<object_id_type>();
+   changed_objects_by_block( snapshot );
 } FC_CAPTURE_AND_RETHROW() }
 
 processed_transaction database::apply_transaction(const signed_transaction& trx, uint32_t skip)
@@ -574,32 +1030,39 @@ processed_transaction database::apply_transaction(const signed_transaction& trx,
 }
 
 processed_transaction database::_apply_transaction(const signed_transaction& trx)
-{ try {
-   uint32_t skip = get_node_properties().skip_flags;
+{
+   return _apply_transaction( sealed_transaction( trx, get_chain_id() ) );
+}
 
-   if( true || !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
-      trx.validate();
+processed_transaction database::_apply_transaction(const sealed_transaction& sealed,
+                                                   const precomputed_transaction_checks* checks)
+{
+   const signed_transaction& trx = sealed.get();
+   try {
+   uint32_t skip = get_node_properties().skip_flags;
+   bool check_signatures = !(skip & (skip_transaction_signatures | skip_authority_check));
 
+   // Duplicates and expired transactions are the cheapest to reject, so check them
+   // before doing any work on the transaction's content or signatures
    auto& trx_idx = get_mutable_index_type<transaction_index>();
-   const chain_id_type& chain_id = get_chain_id();
-   auto trx_id = trx.id();
-   FC_ASSERT( (skip & skip_transaction_dupe_check) ||
-              trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
+   const transaction_id_type& trx_id = sealed.id();
+   GRAPHENE_ASSERT( (skip & skip_transaction_dupe_check) ||
+                    trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end(),
+                    duplicate_transaction, "Duplicate transaction ${id}", ("id",trx_id) );
    transaction_evaluation_state eval_state(this);
    const chain_parameters& chain_parameters = get_global_properties().parameters;
    eval_state._trx = &trx;
 
-   if( !(skip & (skip_transaction_signatures | skip_authority_check) ) )
-   {
-      auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
-      auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
-      trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
-   }
-
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
    //expired, and TaPoS makes no sense as no blocks exist.
    if( BOOST_LIKELY(head_block_num() > 0) )
    {
+      fc::time_point_sec now = head_block_time();
+      GRAPHENE_ASSERT( now <= trx.expiration, expired_transaction, "Transaction expired at ${exp}, head block time is ${now}",
+                       ("now",now)("exp",trx.expiration) );
+      FC_ASSERT( trx.expiration <= now + chain_parameters.maximum_time_until_expiration, "",
+                 ("trx.expiration",trx.expiration)("now",now)("max_til_exp",chain_parameters.maximum_time_until_expiration));
+
       if( !(skip & skip_tapos_check) )
       {
          const auto& tapos_block_summary = block_summary_id_type( trx.ref_block_num )(*this);
@@ -607,12 +1070,43 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
          //Verify TaPoS block summary has correct ID prefix, and that this block's time is not past the expiration
          FC_ASSERT( trx.ref_block_prefix == tapos_block_summary.block_id._hash[1] );
       }
+   }
 
-      fc::time_point_sec now = head_block_time();
+   // A transaction found in the cache already passed validate() and had its keys recovered
+   const digest_type& sig_digest = sealed.sig_digest();
+   // (the block pre-pass already did the lookup, doing it again would count it twice)
+   optional< flat_set<public_key_type> > verified_keys;
+   bool cache_hit = false;
+   if( check_signatures )
+   {
+      if( checks != nullptr && checks->cache_checked )
+         cache_hit = checks->cache_hit;
+      else
+      {
+         verified_keys = _verified_trx_cache.find( sig_digest, trx.signatures );
+         cache_hit = verified_keys.valid();
+      }
+   }
 
-      FC_ASSERT( trx.expiration <= now + chain_parameters.maximum_time_until_expiration, "",
-                 ("trx.expiration",trx.expiration)("now",now)("max_til_exp",chain_parameters.maximum_time_until_expiration));
-      FC_ASSERT( now <= trx.expiration, "", ("now",now)("trx.exp",trx.expiration) );
+   bool validated = cache_hit || ( checks != nullptr && checks->validated );
+   if( !validated )   /* issue #505 explains why the skip_validate flag is disabled */
+      trx.validate();
+
+   if( check_signatures )
+   {
+      if( !verified_keys.valid() )
+      {
+         if( checks != nullptr && checks->signature_keys.valid() )
+            verified_keys = *checks->signature_keys;
+         else
+            verified_keys = sealed.get_signature_keys();
+         if( !cache_hit )
+            _verified_trx_cache.insert( sig_digest, trx.signatures, *verified_keys );
+      }
+      auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
+      auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
+      _authority_cache->verify_authority( trx.operations, *verified_keys, get_active, get_owner,
+                                          get_global_properties().parameters.max_authority_depth );
    }
 
    //Insert transaction into unique transactions database.
@@ -620,8 +1114,10 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    {
       create<transaction_object>([&](transaction_object& transaction) {
          transaction.trx_id = trx_id;
-         transaction.trx = trx;
+         transaction.expiration = trx.expiration;
+         transaction.block_num = head_block_num() + 1;
       });
+      _recent_trx_cache.insert( sealed );
    }
 
    eval_state.operation_results.reserve(trx.operations.size());
@@ -631,7 +1127,10 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    _current_op_in_trx = 0;
    for( const auto& op : ptrx.operations )
    {
-      eval_state.operation_results.emplace_back(apply_operation(eval_state, op));
+      generic_evaluator* evaluated = nullptr;
+      if( checks != nullptr && checks->speculated )
+         evaluated = _reusable_evaluator( (*checks->speculated)[_current_op_in_trx] );
+      eval_state.operation_results.emplace_back(apply_operation(eval_state, op, evaluated));
       ++_current_op_in_trx;
    }
    ptrx.operation_results = std::move(eval_state.operation_results);
@@ -642,9 +1141,90 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    std::for_each(range.first, range.second, [](const account_balance_object& b) { FC_ASSERT(b.balance == 0); });
 
    return ptrx;
-} FC_CAPTURE_AND_RETHROW( (trx) ) }
+} GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW( (trx) ) }
+
+processed_transaction database::_apply_tracked_transaction( const sealed_transaction& trx,
+                                                           const precomputed_transaction_checks* checks,
+                                                           std::shared_ptr<const vector<object_id_type>>& accessed )
+{
+   object_access_set access;
+   set_access_tracker( &access );
+   processed_transaction result;
+   try {
+      result = _apply_transaction( trx, checks );
+   } catch( ... ) {
+      set_access_tracker( nullptr );
+      throw;
+   }
+   set_access_tracker( nullptr );
 
-operation_result database::apply_operation(transaction_evaluation_state& eval_state, const operation& op)
+   auto ids = std::make_shared< vector<object_id_type> >();
+   ids->reserve( access.reads.size() + access.writes.size() );
+   std::set_union( access.reads.begin(), access.reads.end(), access.writes.begin(), access.writes.end(),
+                   std::back_inserter( *ids ) );
+   accessed = std::move( ids );
+   return result;
+}
+
+void database::_speculate_operations( const sealed_block& b, precomputed_block_checks& checks )
+{
+   // the lookup table is built lazily, build it before the workers read it
+   current_fee_schedule();
+
+   const int transfer_tag = operation::tag<transfer_operation>::value;
+   const op_evaluator& transfer_eval = *_operation_evaluators[transfer_tag];
+   std::atomic<uint32_t> speculated( 0 );
+
+   // nothing writes to the database until the pool is done
+   get_thread_pool().parallel_for( b.transactions().size(), [&]( size_t i )
+   {
+      const signed_transaction& trx = b.transactions()[i].get();
+      auto ops = std::make_shared< vector<speculative_operation> >( trx.operations.size() );
+      bool any = false;
+      object_access_set* previous_tracker = get_access_tracker();
+      for( size_t j = 0; j < trx.operations.size(); ++j )
+      {
+         if( trx.operations[j].which() != transfer_tag )
+            continue;
+         object_access_set access;
+         set_access_tracker( &access );
+         try {
+            transaction_evaluation_state eval_state( this );
+            eval_state._trx = &trx;
+            (*ops)[j].evaluator = transfer_eval.evaluate_only( eval_state, trx.operations[j] );
+            (*ops)[j].reads = std::move( access.reads );
+            any = true;
+            ++speculated;
+         } catch( const fc::exception& ) {
+            // left unset, the serial path evaluates it again and reports the error
+         }
+      }
+      set_access_tracker( previous_tracker );
+      if( any )
+         checks.transactions[i].speculated = ops;
+   } );
+   _last_block_speculation_stats.speculated = speculated;
+}
+
+generic_evaluator* database::_reusable_evaluator( const speculative_operation& op )
+{
+   if( !op.evaluator )
+      return nullptr;
+   const object_access_set* trx_access = get_access_tracker();
+   bool changed = _speculation_block_writes == nullptr || trx_access == nullptr;
+   for( auto itr = op.reads.begin(); !changed && itr != op.reads.end(); ++itr )
+      changed = _speculation_block_writes->count( *itr ) || trx_access->writes.count( *itr );
+   if( changed )
+   {
+      ++_last_block_speculation_stats.reevaluated;
+      return nullptr;
+   }
+   ++_last_block_speculation_stats.reused;
+   return op.evaluator.get();
+}
+
+operation_result database::apply_operation(transaction_evaluation_state& eval_state, const operation& op,
+                                           generic_evaluator* evaluated)
 { try {
    int i_which = op.which();
    uint64_t u_which = uint64_t( i_which );
@@ -656,19 +1236,25 @@ operation_result database::apply_operation(transaction_evaluation_state& eval_st
    if( !eval )
       assert( "No registered evaluator for this operation" && false );
    auto op_id = push_applied_operation( op );
-   auto result = eval->evaluate( eval_state, op, true );
+   auto result = evaluated ? evaluated->apply_evaluated( eval_state, op ) : eval->evaluate( eval_state, op, true );
    set_applied_operation_result( op_id, result );
    return result;
 } FC_CAPTURE_AND_RETHROW(  ) }
 
-const witness_object& database::validate_block_header( uint32_t skip, const signed_block& next_block )const
+const witness_object& database::validate_block_header( uint32_t skip, const signed_block& next_block,
+                                                       const optional<public_key_type>& signee )const
 {
    FC_ASSERT( head_block_id() == next_block.previous, "", ("head_block_id",head_block_id())("next.prev",next_block.previous) );
    FC_ASSERT( head_block_time() < next_block.timestamp, "", ("head_block_time",head_block_time())("next",next_block.timestamp)("blocknum",next_block.block_num()) );
    const witness_object& witness = next_block.witness(*this);
 
-   if( !(skip&skip_witness_signature) ) 
-      FC_ASSERT( next_block.validate_signee( witness.signing_key ) );
+   if( !(skip&skip_witness_signature) )
+   {
+      if( signee.valid() )
+         FC_ASSERT( *signee == witness.signing_key );
+      else
+         FC_ASSERT( next_block.validate_signee( witness.signing_key ) );
+   }
 
    if( !(skip&skip_witness_schedule_check) )
    {
@@ -684,7 +1270,7 @@ const witness_object& database::validate_block_header( uint32_t skip, const sign
    return witness;
 }
 
-void database::create_block_summary(const signed_block& next_block)
+void database::create_block_summary(const sealed_block& next_block)
 {
    block_summary_id_type sid(next_block.block_num() & 0xffff );
    modify( sid(*this), [&](block_summary_object& p) {
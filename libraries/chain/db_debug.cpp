@@ -95,6 +95,18 @@ void database::debug_dump()
    */
 }
 
+/**
+ * The price sort keys of orders are not serialized, so an order read from a variant has to
+ * compute them again, like database::open() does for the orders it loads.
+ */
+void debug_update_sort_keys( const object_id_type& oid, object& obj )
+{
+   if( oid.is<limit_order_id_type>() )
+      static_cast<limit_order_object&>( obj ).update_sort_keys();
+   else if( oid.is<call_order_id_type>() )
+      static_cast<call_order_object&>( obj ).update_sort_keys();
+}
+
 void debug_apply_update( database& db, const fc::variant_object& vo )
 {
    static const uint8_t
@@ -156,12 +168,14 @@ void debug_apply_update( database& db, const fc::variant_object& vo )
          {
             idx.object_default( obj );
             idx.object_from_variant( vo, obj );
+            debug_update_sort_keys( oid, obj );
          } );
          break;
       case db_action_update:
          db.modify( db.get_object( oid ), [&]( object& obj )
          {
             idx.object_from_variant( vo, obj );
+            debug_update_sort_keys( oid, obj );
          } );
          break;
       case db_action_delete:
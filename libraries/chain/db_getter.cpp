@@ -54,7 +54,11 @@ const dynamic_global_property_object&database::get_dynamic_global_properties() c
 
 const fee_schedule&  database::current_fee_schedule()const
 {
-   return get_global_properties().parameters.current_fees;
+   const fee_schedule& fees = get_global_properties().parameters.current_fees;
+   // the table is dropped whenever the parameters change, see fee_schedule::build_lookup_table()
+   if( !fees.has_lookup_table() )
+      fees.build_lookup_table();
+   return fees;
 }
 
 time_point_sec database::head_block_time()const
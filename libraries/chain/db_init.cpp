@@ -194,10 +194,12 @@ void database::initialize_indexes()
    auto acnt_index = add_index< primary_index<account_index> >();
    acnt_index->add_secondary_index<account_member_index>();
    acnt_index->add_secondary_index<account_referrer_index>();
+   acnt_index->add_observer( _authority_cache );
 
    add_index< primary_index<committee_member_index> >();
    add_index< primary_index<witness_index> >();
-   add_index< primary_index<limit_order_index > >();
+   auto limit_order_idx = add_index< primary_index<limit_order_index > >();
+   limit_order_idx->add_secondary_index<limit_order_price_level_index>();
    add_index< primary_index<call_order_index > >();
 
    auto prop_index = add_index< primary_index<proposal_index > >();
@@ -211,7 +213,8 @@ void database::initialize_indexes()
 
    //Implementation object indexes
    add_index< primary_index<transaction_index                             > >();
-   add_index< primary_index<account_balance_index                         > >();
+   auto bal_index = add_index< primary_index<account_balance_index> >();
+   bal_index->add_secondary_index<balances_by_asset_index>();
    add_index< primary_index<asset_bitasset_data_index                     > >();
    add_index< primary_index<simple_index<global_property_object          >> >();
    add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
@@ -505,6 +508,7 @@ void database::init_genesis(const genesis_state_type& genesis_state)
                c.call_price = price::call_price(chain::asset(c.debt, new_asset_id),
                                                 chain::asset(c.collateral, core_asset.id),
                                                 GRAPHENE_DEFAULT_MAINTENANCE_COLLATERAL_RATIO);
+               c.update_sort_keys();
             });
 
             total_supplies[ asset_id_type(0) ] += collateral_rec.collateral;
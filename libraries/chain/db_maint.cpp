@@ -485,6 +485,9 @@ void visit_special_authorities( const database& db, Visitor visit )
 
 void update_top_n_authorities( database& db )
 {
+   const auto& bal_idx = dynamic_cast< const primary_index< account_balance_index >& >(
+      db.get_index_type< account_balance_index >() ).get_secondary_index< balances_by_asset_index >();
+
    visit_special_authorities( db,
    [&]( const account_object& acct, bool is_owner, const special_authority& auth )
    {
@@ -494,15 +497,14 @@ void update_top_n_authorities( database& db )
 
          const top_holders_special_authority& tha = auth.get< top_holders_special_authority >();
          vote_counter vc;
-         const auto& bal_idx = db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
          uint8_t num_needed = tha.num_top_holders;
          if( num_needed == 0 )
             return;
 
          // find accounts
-         const auto range = bal_idx.equal_range( boost::make_tuple( tha.asset ) );
-         for( const account_balance_object& bal : boost::make_iterator_range( range.first, range.second ) )
+         for( const account_balance_object* bal_ptr : bal_idx.get_balances_by_amount( tha.asset ) )
          {
+             const account_balance_object& bal = *bal_ptr;
              assert( bal.asset_type == tha.asset );
              if( bal.owner == acct.id )
                 continue;
@@ -831,6 +833,8 @@ void database::perform_chain_maintenance(const signed_block& next_block, const g
          p.pending_parameters.reset();
       }
    });
+   // resolve the fee parameters of the new schedule once instead of on every fee calculation
+   gpo.parameters.current_fees->build_lookup_table();
 
    auto next_maintenance_time = get<dynamic_global_property_object>(dynamic_global_property_id_type()).next_maintenance_time;
    auto maintenance_interval = gpo.parameters.maintenance_interval;
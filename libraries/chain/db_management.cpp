@@ -24,8 +24,10 @@
 
 #include <graphene/chain/database.hpp>
 
+#include <graphene/chain/market_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
+#include <graphene/chain/thread_pool.hpp>
 
 #include <fc/io/fstream.hpp>
 
@@ -99,6 +101,31 @@ void database::reindex(fc::path data_dir, const genesis_state_type& initial_allo
    ilog( "Done reindexing, elapsed time: ${t} sec", ("t",double((end-start).count())/1000000.0 ) );
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
 
+size_t database::push_saved_pending_transactions( size_t max_count, uint32_t skip )
+{
+   fc::time_point_sec now = head_block_time();
+   size_t pushed = 0;
+   while( pushed < max_count && !_saved_pending_tx.empty() )
+   {
+      signed_transaction trx = std::move( _saved_pending_tx.front() );
+      _saved_pending_tx.pop_front();
+      if( trx.expiration < now || is_known_transaction( trx.id() ) )
+         continue;
+      ++pushed;
+      try
+      {
+         push_transaction( trx, skip );
+      }
+      catch( const fc::exception& )
+      {
+         // no longer valid, like any pending transaction after a block
+      }
+   }
+   if( _saved_pending_tx.empty() && pushed > 0 )
+      ilog( "Done pushing the pending transactions saved on shutdown" );
+   return _saved_pending_tx.size();
+}
+
 void database::wipe(const fc::path& data_dir, bool include_blocks)
 {
    ilog("Wiping database", ("include_blocks", include_blocks));
@@ -116,6 +143,16 @@ void database::open(
    {
       object_database::open(data_dir);
 
+      // The sort keys of the market orders are not saved with them, so the orders were loaded
+      // under empty keys.  Compute the keys again, which moves the orders to their place in
+      // the indexes, without recording any undo history.
+      _undo_db.disable();
+      for( const limit_order_object& o : get_index_type<limit_order_index>().indices() )
+         modify( o, []( limit_order_object& order ) { order.update_sort_keys(); } );
+      for( const call_order_object& o : get_index_type<call_order_index>().indices() )
+         modify( o, []( call_order_object& call ) { call.update_sort_keys(); } );
+      _undo_db.enable();
+
       _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
 
       if( !find(global_property_id_type()) )
@@ -131,6 +168,27 @@ void database::open(
               FC_ASSERT( head_block_num() == 0, "last block ID does not match current chain state" );
          }
       }
+
+      // Load the pending transactions saved on close.  The file is removed right away, so
+      // that transactions which were pushed again are not loaded a second time after a crash.
+      fc::path pending_file = data_dir / "database" / "pending_transactions";
+      if( fc::exists( pending_file ) )
+      {
+         try
+         {
+            std::string packed;
+            fc::read_file_contents( pending_file, packed );
+            vector<signed_transaction> saved = fc::raw::unpack< vector<signed_transaction> >(
+               vector<char>( packed.begin(), packed.end() ) );
+            _saved_pending_tx.assign( saved.begin(), saved.end() );
+            ilog( "Loaded ${n} pending transactions saved on shutdown", ("n", _saved_pending_tx.size()) );
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "Ignoring unreadable saved pending transactions: ${e}", ("e", e.to_string()) );
+         }
+         fc::remove( pending_file );
+      }
       //idump((head_block_id())(head_block_num()));
    }
    FC_CAPTURE_LOG_AND_RETHROW( (data_dir) )
@@ -138,7 +196,19 @@ void database::open(
 
 void database::close(bool rewind)
 {
-   // TODO:  Save pending tx's on close()
+   if( _operation_profiler.enabled() )
+      ilog( "Evaluator timings:\n${report}", ("report", _operation_profiler.report()) );
+
+   // Keep the pending transactions, and those which were saved but not pushed yet, so the
+   // node does not have to receive them again after a restart.  The transactions of the
+   // blocks popped below come back with those blocks.
+   vector<signed_transaction> saved;
+   if( _block_id_to_block.is_open() )
+   {
+      saved.reserve( _pending_pool.size() + _saved_pending_tx.size() );
+      for( const auto& entry : _pending_pool.entries() )
+         saved.push_back( entry.trx.get() );
+   }
    clear_pending();
 
    // pop all of the blocks that we can given our undo history, this should
@@ -174,6 +244,40 @@ void database::close(bool rewind)
    // DB state (issue #336).
    clear_pending();
 
+   if( _block_id_to_block.is_open() )
+   {
+      saved.insert( saved.end(), _saved_pending_tx.begin(), _saved_pending_tx.end() );
+      fc::path pending_file = get_data_dir() / "database" / "pending_transactions";
+      try
+      {
+         if( saved.empty() )
+         {
+            if( fc::exists( pending_file ) )
+               fc::remove( pending_file );
+         }
+         else
+         {
+            // write next to the old file and swap it in, so a failed write never leaves half a file
+            fc::path tmp_file = get_data_dir() / "database" / "pending_transactions.tmp";
+            {
+               std::ofstream out( tmp_file.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+               FC_ASSERT( out, "Unable to write ${f}", ("f", tmp_file) );
+               vector<char> packed = fc::raw::pack( saved );
+               out.write( packed.data(), packed.size() );
+               out.close();
+               FC_ASSERT( out, "Unable to write ${f}", ("f", tmp_file) );
+            }
+            fc::rename( tmp_file, pending_file );
+            ilog( "Saved ${n} pending transactions", ("n", saved.size()) );
+         }
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Unable to save the pending transactions: ${e}", ("e", e.to_string()) );
+      }
+   }
+   _saved_pending_tx.clear();
+
    object_database::flush();
    object_database::close();
 
@@ -351,6 +351,7 @@ bool database::fill_order( const call_order_object& order, const asset& pays, co
               collateral_freed = o.get_collateral();
               o.collateral = 0;
             }
+            o.update_sort_keys();
        });
    const asset_object& mia = receives.asset_id(*this);
    assert( mia.is_market_issued() );
@@ -464,18 +465,30 @@ bool database::check_call_orders(const asset_object& mia, bool enable_black_swan
     bool filled_limit = false;
     bool margin_called = false;
 
-    while( !check_for_blackswan( mia, enable_black_swan ) && call_itr != call_end )
+    // The feed cannot change while this loop runs, and as long as limit_itr is in range it is the
+    // highest bid, so the black swan test only has to look up the least collateralized call again.
+    const price settle_price = bitasset.current_feed.settlement_price;
+
+    while( true )
     {
+       if( limit_itr == limit_end )
+       {
+          check_for_blackswan( mia, enable_black_swan );
+          return margin_called;
+       }
+       auto least_collateral_itr = call_price_index.lower_bound( call_min );
+       if( least_collateral_itr != call_end &&
+           check_for_blackswan( mia, enable_black_swan, settle_price, &*limit_itr, *least_collateral_itr ) )
+          return margin_called;
+       if( call_itr == call_end )
+          return margin_called;
+
        bool  filled_call      = false;
        price match_price;
        asset usd_for_sale;
-       if( limit_itr != limit_end )
-       {
-          assert( limit_itr != limit_price_index.end() );
-          match_price      = limit_itr->sell_price;
-          usd_for_sale     = limit_itr->amount_for_sale();
-       }
-       else return margin_called;
+       assert( limit_itr != limit_price_index.end() );
+       match_price      = limit_itr->sell_price;
+       usd_for_sale     = limit_itr->amount_for_sale();
 
        match_price.validate();
 
@@ -541,9 +554,7 @@ bool database::check_call_orders(const asset_object& mia, bool enable_black_swan
        auto old_limit_itr = filled_limit ? limit_itr++ : limit_itr;
        fill_order(*old_limit_itr, order_pays, order_receives, true);
 
-    } // whlie call_itr != call_end
-
-    return margin_called;
+    } // while true
 } FC_CAPTURE_AND_RETHROW() }
 
 void database::pay_order( const account_object& receiver, const asset& receives, const asset& pays )
@@ -40,8 +40,9 @@
 
 namespace graphene { namespace chain {
 
-void database::update_global_dynamic_data( const signed_block& b )
+void database::update_global_dynamic_data( const sealed_block& sealed )
 {
+   const signed_block& b = sealed.get();
    const dynamic_global_property_object& _dgp =
       dynamic_global_property_id_type(0)(*this);
 
@@ -77,7 +78,7 @@ void database::update_global_dynamic_data( const signed_block& b )
          dgp.recently_missed_count--;
 
       dgp.head_block_number = b.block_num();
-      dgp.head_block_id = b.id();
+      dgp.head_block_id = sealed.id();
       dgp.time = b.timestamp;
       dgp.current_witness = b.witness;
       dgp.recent_slots_filled = (
@@ -162,7 +163,7 @@ void database::clear_expired_transactions()
    //Transactions must have expired by at least two forking windows in order to be removed.
    auto& transaction_idx = static_cast<transaction_index&>(get_mutable_index(implementation_ids, impl_transaction_object_type));
    const auto& dedupe_index = transaction_idx.indices().get<by_expiration>();
-   while( (!dedupe_index.empty()) && (head_block_time() > dedupe_index.rbegin()->trx.expiration) )
+   while( (!dedupe_index.empty()) && (head_block_time() > dedupe_index.rbegin()->expiration) )
       transaction_idx.remove(*dedupe_index.rbegin());
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -229,13 +230,20 @@ bool database::check_for_blackswan( const asset_object& mia, bool enable_black_s
 
     if( call_itr == call_end ) return false;  // no call orders
 
+    return check_for_blackswan( mia, enable_black_swan, settle_price,
+                                limit_itr != limit_end ? &*limit_itr : nullptr, *call_itr );
+}
+
+bool database::check_for_blackswan( const asset_object& mia, bool enable_black_swan, const price& settle_price,
+                                    const limit_order_object* highest_bid, const call_order_object& least_collateral_call )
+{
     price highest = settle_price;
-    if( limit_itr != limit_end ) {
-       assert( settle_price.base.asset_id == limit_itr->sell_price.base.asset_id );
-       highest = std::max( limit_itr->sell_price, settle_price );
+    if( highest_bid != nullptr ) {
+       assert( settle_price.base.asset_id == highest_bid->sell_price.base.asset_id );
+       highest = std::max( highest_bid->sell_price, settle_price );
     }
 
-    auto least_collateral = call_itr->collateralization();
+    auto least_collateral = least_collateral_call.collateralization();
     if( ~least_collateral >= highest  ) 
     {
        elog( "Black Swan detected: \n"
@@ -426,6 +434,9 @@ void database::clear_expired_orders()
 
 void database::update_expired_feeds()
 {
+   // Margin calls only depend on the feed of the asset being called, so all medians are refreshed
+   // first and the affected markets are checked afterwards, in the same (id) order as before.
+   flat_set<asset_id_type> assets_to_check;
    auto& asset_idx = get_index_type<asset_index>().indices().get<by_type>();
    auto itr = asset_idx.lower_bound( true /** market issued */ );
    while( itr != asset_idx.end() )
@@ -445,7 +456,7 @@ void database::update_expired_feeds()
          modify(b, [this](asset_bitasset_data_object& a) {
             a.update_median_feeds(head_block_time());
          });
-         check_call_orders(b.current_feed.settlement_price.base.asset_id(*this));
+         assets_to_check.insert( b.current_feed.settlement_price.base.asset_id );
       }
       if( !b.current_feed.core_exchange_rate.is_null() &&
           a.options.core_exchange_rate != b.current_feed.core_exchange_rate )
@@ -453,6 +464,9 @@ void database::update_expired_feeds()
             a.options.core_exchange_rate = b.current_feed.core_exchange_rate;
          });
    }
+
+   for( const asset_id_type& id : assets_to_check )
+      check_call_orders( id(*this) );
 }
 
 void database::update_maintenance_flag( bool new_maintenance_flag )
@@ -43,12 +43,32 @@ database& generic_evaluator::db()const { return trx_state->db(); }
    operation_result generic_evaluator::start_evaluate( transaction_evaluation_state& eval_state, const operation& op, bool apply )
    { try {
       trx_state   = &eval_state;
+      profiler    = get_operation_profiler();
       //check_required_authorities(op);
       auto result = evaluate( op );
 
       if( apply ) result = this->apply( op );
+      if( profiler )
+         profiler->record( get_type(), operation_profiler::fee_phase, fee_handling_ns );
       return result;
-   } FC_CAPTURE_AND_RETHROW() }
+   } GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW() }
+
+   void generic_evaluator::evaluate_only( transaction_evaluation_state& eval_state, const operation& op )
+   { try {
+      trx_state   = &eval_state;
+      profiler    = nullptr;
+      evaluate( op );
+   } GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW() }
+
+   operation_result generic_evaluator::apply_evaluated( transaction_evaluation_state& eval_state, const operation& op )
+   { try {
+      trx_state   = &eval_state;
+      profiler    = get_operation_profiler();
+      auto result = this->apply( op );
+      if( profiler )
+         profiler->record( get_type(), operation_profiler::fee_phase, fee_handling_ns );
+      return result;
+   } GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW() }
 
    void generic_evaluator::prepare_fee(account_id_type account_id, asset fee)
    {
@@ -123,9 +143,18 @@ database& generic_evaluator::db()const { return trx_state->db(); }
    {
      return db().current_fee_schedule().calculate_fee( op ).amount;
    }
+   const fee_schedule& generic_evaluator::current_fee_schedule()const
+   {
+     return db().current_fee_schedule();
+   }
    void generic_evaluator::db_adjust_balance(const account_id_type& fee_payer, asset fee_from_account)
    {
      db().adjust_balance(fee_payer, fee_from_account);
    }
+   operation_profiler* generic_evaluator::get_operation_profiler()const
+   {
+     operation_profiler& p = db().get_operation_profiler();
+     return p.enabled() ? &p : nullptr;
+   }
 
 } }
@@ -57,13 +57,22 @@ void     fork_database::start_block(signed_block b)
  */
 shared_ptr<fork_item>  fork_database::push_block(const signed_block& b)
 {
-   auto item = std::make_shared<fork_item>(b);
+   return push_item( std::make_shared<fork_item>(b) );
+}
+
+shared_ptr<fork_item>  fork_database::push_block(const sealed_block& b)
+{
+   return push_item( std::make_shared<fork_item>(b) );
+}
+
+shared_ptr<fork_item>  fork_database::push_item(const item_ptr& item)
+{
    try {
       _push_block(item);
    }
    catch ( const unlinkable_block_exception& e )
    {
-      wlog( "Pushing block to fork database that failed to link: ${id}, ${num}", ("id",b.id())("num",b.block_num()) );
+      wlog( "Pushing block to fork database that failed to link: ${id}, ${num}", ("id",item->id)("num",item->num) );
       wlog( "Head: ${num}, ${id}", ("num",_head->data.block_num())("id",_head->data.id()) );
       throw;
       _unlinked_index.insert( item );
@@ -25,6 +25,8 @@
 #include <graphene/chain/protocol/operations.hpp>
 #include <graphene/db/generic_index.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <unordered_set>
 
 namespace graphene { namespace chain {
    class database;
@@ -309,10 +311,53 @@ namespace graphene { namespace chain {
          map< account_id_type, set<account_id_type> > referred_by;
    };
 
+   /**
+    *  @brief This secondary index lists the balances of an asset ordered by amount, largest first.
+    *
+    *  Only a few readers need this order, while nearly every operation changes some balance.  So
+    *  changes are only noted here, and the order is restored in bulk when it is read: the changed
+    *  balances are sorted among themselves and merged back into the untouched ones.
+    *
+    *  Balances which undo puts back are seen through object_inserted(), which primary_index::insert
+    *  calls for them just like for new ones.
+    */
+   class balances_by_asset_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /** @return the balances of the asset, by amount descending and then by owner */
+         const vector<const account_balance_object*>& get_balances_by_amount( asset_id_type asset )const;
+
+         /** @return the number of balance changes of the asset not merged into the order yet */
+         size_t pending_changes( asset_id_type asset )const;
+
+      private:
+         struct asset_balances
+         {
+            /// in order, except for the balances listed in changed or removed
+            vector<const account_balance_object*>            sorted;
+            /// inserted or modified since the last merge
+            std::unordered_set<const account_balance_object*> changed;
+            /// removed since the last merge, only compared against, never dereferenced
+            std::unordered_set<const account_balance_object*> removed;
+         };
+
+         static void merge_changes( asset_balances& balances );
+
+         mutable map< asset_id_type, asset_balances > _balances;
+   };
+
    struct by_account_asset;
-   struct by_asset_balance;
+   struct by_account_asset_hash;
    /**
     * @ingroup object_index
+    *
+    * by_account_asset_hash serves the point lookups of get_balance() and adjust_balance(),
+    * by_account_asset is kept for iterating over the balances of an account.  Balances ordered
+    * by amount are provided by balances_by_asset_index.
     */
    typedef multi_index_container<
       account_balance_object,
@@ -325,17 +370,11 @@ namespace graphene { namespace chain {
                member<account_balance_object, asset_id_type, &account_balance_object::asset_type>
             >
          >,
-         ordered_unique< tag<by_asset_balance>,
+         hashed_unique< tag<by_account_asset_hash>,
             composite_key<
                account_balance_object,
-               member<account_balance_object, asset_id_type, &account_balance_object::asset_type>,
-               member<account_balance_object, share_type, &account_balance_object::balance>,
-               member<account_balance_object, account_id_type, &account_balance_object::owner>
-            >,
-            composite_key_compare<
-               std::less< asset_id_type >,
-               std::greater< share_type >,
-               std::less< account_id_type >
+               member<account_balance_object, account_id_type, &account_balance_object::owner>,
+               member<account_balance_object, asset_id_type, &account_balance_object::asset_type>
             >
          >
       >
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/chain/protocol/transaction.hpp>
+#include <graphene/db/index.hpp>
+
+#include <unordered_set>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief remembers authority checks which passed
+    *
+    *  Checking the authorities of a transaction walks the active and owner authorities of every
+    *  required account, recursing into the accounts they name, and derives the addresses of the
+    *  signing keys when an authority contains addresses.  Transactions sent by the same accounts
+    *  and signed by the same keys repeat the same walk, so its result is kept here, keyed by a
+    *  hash of the required authorities, the signing keys and the recursion limit.
+    *
+    *  The result also depends on the authorities of the accounts that were walked.  The cache is
+    *  installed as an observer of the account index and is cleared whenever any account is
+    *  created, modified or removed, which covers account_update_operation as well as undo.  It is
+    *  also cleared before each block is applied, so it never grows beyond a block's worth of
+    *  transactions and their pending successors.
+    */
+   class authority_check_cache : public graphene::db::index_observer
+   {
+      public:
+         struct stats
+         {
+            uint64_t hits   = 0;
+            uint64_t misses = 0;
+            uint32_t size   = 0;
+         };
+
+         /**
+          *  Same as graphene::chain::verify_authority() with no approvals and without allowing the
+          *  committee account, skipping the check if the same check passed before
+          */
+         void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
+                                const std::function<const authority*(account_id_type)>& get_active,
+                                const std::function<const authority*(account_id_type)>& get_owner,
+                                uint32_t max_recursion );
+
+         void  clear() { _passed.clear(); }
+         stats get_stats()const;
+
+         virtual void on_add( const graphene::db::object& obj )override     { clear(); }
+         virtual void on_remove( const graphene::db::object& obj )override  { clear(); }
+         virtual void on_modify( const graphene::db::object& obj )override  { clear(); }
+
+      private:
+         std::unordered_set< digest_type, std::hash<digest_type> > _passed;
+         stats                                                     _stats;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::authority_check_cache::stats, (hits)(misses)(size) )
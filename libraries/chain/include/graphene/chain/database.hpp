@@ -30,6 +30,11 @@
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/verified_transaction_cache.hpp>
+#include <graphene/chain/authority_check_cache.hpp>
+#include <graphene/chain/operation_profiler.hpp>
+#include <graphene/chain/recent_transaction_cache.hpp>
+#include <graphene/chain/pending_transaction_pool.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
@@ -41,15 +46,110 @@
 #include <fc/log/logger.hpp>
 
 #include <map>
+#include <unordered_set>
 
 namespace graphene { namespace chain {
    using graphene::db::abstract_object;
    using graphene::db::object;
    class op_evaluator;
    class transaction_evaluation_state;
+   class thread_pool;
 
    struct budget_record;
 
+   /**
+    *  @brief an operation whose evaluate() already ran on a worker thread, against the state at the
+    *  start of its block
+    */
+   struct speculative_operation
+   {
+      /// unset when the operation was not speculated or its checks failed
+      std::shared_ptr<generic_evaluator> evaluator;
+      /// the objects evaluate() read, it has to run again if any of them was written since
+      flat_set<object_id_type>           reads;
+   };
+
+   /**
+    *  @brief results of the checks of one transaction that need no chain state
+    */
+   struct precomputed_transaction_checks
+   {
+      /// transaction::validate() passed
+      bool                                  validated = false;
+      optional< flat_set<public_key_type> > signature_keys;
+      /// the verified transaction cache was already consulted, and whether signature_keys came from it
+      bool                                  cache_checked = false;
+      bool                                  cache_hit = false;
+      /// one entry per operation, set by speculative execution, see set_speculative_execution()
+      std::shared_ptr< vector<speculative_operation> > speculated;
+   };
+
+   /**
+    *  @brief results of the stateless checks of a block, run on the worker pool before the
+    *  block is applied
+    *
+    *  A check that failed is left unset, so that the serial path runs the original check
+    *  and reports the original error.
+    */
+   struct precomputed_block_checks
+   {
+      block_id_type                                     block_id;
+      optional<public_key_type>                         signee;
+      vector< precomputed_transaction_checks >          transactions;
+   };
+
+   /**
+    *  @brief how much of a block could have been executed in parallel, measured from the objects
+    *  each transaction accessed
+    *
+    *  A transaction conflicts when it reads or writes an object written by an earlier transaction
+    *  of the block, so optimistic execution would have to run it again after the earlier one.
+    */
+   struct transaction_conflict_stats
+   {
+      uint32_t block_num = 0;
+      uint32_t transactions = 0;
+      /// transactions that access an object written by an earlier transaction
+      uint32_t conflicting = 0;
+      /// length of the longest chain of conflicting transactions, the minimum number of rounds
+      /// of parallel execution
+      uint32_t rounds = 0;
+   };
+
+   /**
+    *  @brief how the operations of the last applied block were executed in speculative mode
+    */
+   struct speculative_execution_stats
+   {
+      uint32_t block_num = 0;
+      /// operations whose evaluate() ran on the worker pool before the block was applied
+      uint32_t speculated = 0;
+      /// speculated operations that only had to be applied
+      uint32_t reused = 0;
+      /// speculated operations evaluated again because an earlier operation wrote what they read
+      uint32_t reevaluated = 0;
+   };
+
+   /**
+    *  @brief where the time of the last generate_block() call went, in microseconds
+    */
+   struct block_generation_timings
+   {
+      uint32_t block_num = 0;
+      uint32_t transactions = 0;
+      /// true if the block was a candidate prepared ahead of its slot, see prepare_block_candidate()
+      bool     preassembled = false;
+      /// applying the pending transactions to fill the block, zero when preassembled
+      int64_t  assemble_us = 0;
+      /// merkle root and witness signature
+      int64_t  sign_us = 0;
+      /// pushing the block, without re-applying the pending transactions
+      int64_t  apply_us = 0;
+      /// re-applying the pending transactions on top of the new block
+      int64_t  restore_pending_us = 0;
+      int64_t  total_us = 0;
+   };
+
    /**
     *   @class database
     *   @brief tracks the blockchain state in an extensible manner
@@ -109,8 +209,23 @@ namespace graphene { namespace chain {
           * Will close the database before wiping. Database will be closed when this function returns.
           */
          void wipe(const fc::path& data_dir, bool include_blocks);
+         /**
+          * Saves the pending transactions to the data directory, so that the next open() can load
+          * them back.
+          */
          void close(bool rewind = true);
 
+         /**
+          *  Pushes up to @p max_count of the pending transactions saved by the last close(), in the
+          *  order they were saved.  Expired and already included transactions are dropped without
+          *  being pushed, as are those which fail.  Meant to be called once the node is in sync,
+          *  a batch at a time.
+          *
+          *  @return the number of saved transactions left
+          */
+         size_t push_saved_pending_transactions( size_t max_count, uint32_t skip = skip_nothing );
+         size_t saved_pending_transactions()const { return _saved_pending_tx.size(); }
+
          //////////////////// db_block.cpp ////////////////////
 
          /**
@@ -122,7 +237,11 @@ namespace graphene { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
-         const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
+         /**
+          *  @return a transaction which is known to the duplicate check, from the cache of recent
+          *  transactions, the pending transactions or its block
+          */
+         signed_transaction         get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
          /**
@@ -136,9 +255,30 @@ namespace graphene { namespace chain {
          bool before_last_checkpoint()const;
 
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
+         bool push_block( const sealed_block& b, uint32_t skip = skip_nothing );
          processed_transaction push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          bool _push_block( const signed_block& b );
-         processed_transaction _push_transaction( const signed_transaction& trx );
+         bool _push_block( const sealed_block& b );
+         /**
+          *  @param readmit true for transactions which were in the pending pool or in a popped
+          *  block already; they are not refused for a full pool or a fee payer quota, the pool is
+          *  trimmed after adding them
+          */
+         processed_transaction _push_transaction( const signed_transaction& trx, bool readmit = false );
+         processed_transaction _push_transaction( const sealed_transaction& trx, bool readmit = false );
+         /**
+          *  Applies a transaction of the pending pool to the pending state again after a block,
+          *  without checking its signatures, authorities and TaPoS: only valid for transactions
+          *  that accessed none of the objects the block changed.
+          */
+         void                  _carry_over_pending_transaction( pending_transaction_pool::entry e );
+         /**
+          *  The sorted ids of the objects the head block modified or removed, if the head block
+          *  was applied right on top of @p previous_head.  Empty if the head is still
+          *  @p previous_head, unset if the blocks in between are not known or if the changes may
+          *  affect the authority checks of any transaction.
+          */
+         optional< vector<object_id_type> > _objects_changed_since( const block_id_type& previous_head )const;
 
          ///@throws fc::exception if the proposed transaction fails to apply.
          processed_transaction push_proposal( const proposal_object& proposal );
@@ -155,9 +295,84 @@ namespace graphene { namespace chain {
             const fc::ecc::private_key& block_signing_private_key
             );
 
+         /**
+          *  Picks and applies the transactions of the next block ahead of its slot, so that
+          *  generate_block() only has to add the header and sign it.  The pending state then holds
+          *  the transactions of the candidate, followed by the pool transactions which did not fit
+          *  in it; transactions pushed afterwards are appended to the candidate as long as nothing
+          *  was left out of it and they fit.  The candidate is dropped when the head block changes.
+          *
+          *  @return the number of transactions in the candidate
+          */
+         uint32_t prepare_block_candidate( uint32_t skip = skip_nothing );
+
          void pop_block();
          void clear_pending();
 
+         /**
+          *  Validates every transaction of the block and recovers the witness signee and the
+          *  signing keys on the worker pool.  Checks disabled by skip are not precomputed.
+          */
+         precomputed_block_checks precompute_block_checks( const sealed_block& b, uint32_t skip )const;
+
+         /// Seals the block, packing and hashing its transactions on the worker pool
+         sealed_block seal_block( const signed_block& b )const;
+
+         /**
+          *  The block that is being applied while applied_block is emitted, so observers can reuse
+          *  the ids and digests computed for it.  nullptr outside of the applied_block signal.
+          */
+         const sealed_block* get_applying_block()const { return _applying_block; }
+
+         /**
+          *  Sets the number of worker threads used for stateless checks of incoming blocks.
+          *  By default one less than the number of CPU cores is used, 0 keeps all work on the
+          *  calling thread.
+          */
+         void         set_worker_thread_count( uint32_t thread_count );
+         thread_pool& get_thread_pool()const;
+         /// runs the tasks it is given on the worker pool, for the parallel helpers of signed_block
+         for_each_index_type get_worker_for_each()const;
+
+         /**
+          *  Records the objects accessed by each transaction of the blocks applied from now on and
+          *  measures how many transactions conflict.  This is a diagnostic mode, it does not change
+          *  how transactions are applied.
+          */
+         void set_track_transaction_conflicts( bool track ) { _track_transaction_conflicts = track; }
+         const transaction_conflict_stats& get_last_block_conflict_stats()const { return _last_block_conflict_stats; }
+         const block_generation_timings& get_last_generation_timings()const { return _last_generation_timings; }
+
+         /**
+          *  Optimistic parallel execution of the blocks applied from now on.  Before the transactions
+          *  of a block are applied, the checks of their transfers (evaluate()) run on the worker pool
+          *  against the state at the start of the block, recording the objects they read.  The block is
+          *  then applied in order as usual, and a transfer skips its checks when nothing it read was
+          *  written by an earlier operation of the block; otherwise it is evaluated again serially.
+          *  The resulting state is the same as without this mode.
+          *
+          *  Only transfers are speculated: the other evaluators have not been audited for reads that
+          *  bypass the object database or for side effects in evaluate(), and all writes stay serial
+          *  because object ids, the undo history and the applied operations are ordered.
+          */
+         void set_speculative_execution( bool enabled ) { _speculative_execution = enabled; }
+         const speculative_execution_stats& get_last_block_speculation_stats()const { return _last_block_speculation_stats; }
+
+         /// Signature keys and validate() results of transactions checked earlier
+         verified_transaction_cache&       get_verified_transaction_cache()       { return _verified_trx_cache; }
+         const verified_transaction_cache& get_verified_transaction_cache()const  { return _verified_trx_cache; }
+         /// Authority checks of transactions that passed, since the last account change or block
+         const authority_check_cache&      get_authority_check_cache()const       { return *_authority_cache; }
+         /// Bodies of the most recently applied transactions, see get_recent_transaction()
+         recent_transaction_cache&         get_recent_transaction_cache()         { return _recent_trx_cache; }
+         const recent_transaction_cache&   get_recent_transaction_cache()const    { return _recent_trx_cache; }
+         /// Transactions pushed since the head block, see pending_transaction_pool
+         pending_transaction_pool&         get_pending_transaction_pool()         { return _pending_pool; }
+         const pending_transaction_pool&   get_pending_transaction_pool()const    { return _pending_pool; }
+         /// Call counts and latencies of the evaluators, see operation_profiler::enable()
+         operation_profiler&               get_operation_profiler()               { return _operation_profiler; }
+         const operation_profiler&         get_operation_profiler()const          { return _operation_profiler; }
+
          /**
           *  This method is used to track appied operations during the evaluation of a block, these
           *  operations should include any operation actually included in a transaction as well
@@ -200,6 +415,15 @@ namespace graphene { namespace chain {
           */
          fc::signal<void(const vector<const object*>&)>  removed_objects;
 
+         /**
+          *  Emitted once at the end of every applied block with the sorted, de-duplicated
+          *  ids of every object reported since the previous emission, including those
+          *  touched by pending transactions.  All listeners share the same immutable
+          *  snapshot, so it may be kept or handed to another thread without copying.
+          *  Ids are only collected while at least one listener is connected.
+          */
+         fc::signal<void(const std::shared_ptr<const vector<object_id_type>>&)> changed_objects_by_block;
+
          //////////////////// db_witness_schedule.cpp ////////////////////
 
          /**
@@ -399,6 +623,7 @@ namespace graphene { namespace chain {
          //Mark pop_undo() as protected -- we do not want outside calling pop_undo(); it should call pop_block() instead
          void pop_undo() { object_database::pop_undo(); }
          void notify_changed_objects();
+         void notify_block_changed_objects();
 
       private:
          optional<undo_database::session>       _pending_tx_session;
@@ -412,21 +637,34 @@ namespace graphene { namespace chain {
        public:
          // these were formerly private, but they have a fairly well-defined API, so let's make them public
          void                  apply_block( const signed_block& next_block, uint32_t skip = skip_nothing );
+         void                  apply_block( const sealed_block& next_block, uint32_t skip = skip_nothing );
          processed_transaction apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
-         operation_result      apply_operation( transaction_evaluation_state& eval_state, const operation& op );
+         operation_result      apply_operation( transaction_evaluation_state& eval_state, const operation& op,
+                                                generic_evaluator* evaluated = nullptr );
       private:
-         void                  _apply_block( const signed_block& next_block );
+         void                  _apply_block( const sealed_block& next_block );
+         /// runs evaluate() of the block's transfers on the worker pool, see set_speculative_execution()
+         void                  _speculate_operations( const sealed_block& b, precomputed_block_checks& checks );
+         /// @return the evaluator of a speculated operation if nothing it read was written since
+         generic_evaluator*    _reusable_evaluator( const speculative_operation& op );
          processed_transaction _apply_transaction( const signed_transaction& trx );
+         processed_transaction _apply_transaction( const sealed_transaction& trx,
+                                                   const precomputed_transaction_checks* checks = nullptr );
+         /// _apply_transaction(), also returning the sorted ids of the objects it read or wrote
+         processed_transaction _apply_tracked_transaction( const sealed_transaction& trx,
+                                                           const precomputed_transaction_checks* checks,
+                                                           std::shared_ptr<const vector<object_id_type>>& accessed );
 
          ///Steps involved in applying a new block
          ///@{
 
-         const witness_object& validate_block_header( uint32_t skip, const signed_block& next_block )const;
+         const witness_object& validate_block_header( uint32_t skip, const signed_block& next_block,
+                                                      const optional<public_key_type>& signee = optional<public_key_type>() )const;
          const witness_object& _validate_block_header( const signed_block& next_block )const;
-         void create_block_summary(const signed_block& next_block);
+         void create_block_summary(const sealed_block& next_block);
 
          //////////////////// db_update.cpp ////////////////////
-         void update_global_dynamic_data( const signed_block& b );
+         void update_global_dynamic_data( const sealed_block& b );
          void update_signing_witness(const witness_object& signing_witness, const signed_block& new_block);
          void update_last_irreversible_block();
          void clear_expired_transactions();
@@ -436,6 +674,9 @@ namespace graphene { namespace chain {
          void update_maintenance_flag( bool new_maintenance_flag );
          void update_withdraw_permissions();
          bool check_for_blackswan( const asset_object& mia, bool enable_black_swan = true );
+         /// Same test with the settlement price, highest bid and least collateralized call already looked up
+         bool check_for_blackswan( const asset_object& mia, bool enable_black_swan, const price& settle_price,
+                                   const limit_order_object* highest_bid, const call_order_object& least_collateral_call );
 
          void remove_expired_music_contracts( );
 
@@ -457,9 +698,50 @@ namespace graphene { namespace chain {
          ///@}
          ///@}
 
-         vector< processed_transaction >        _pending_tx;
+         /// transactions of the next block, applied to the pending state ahead of its slot
+         struct block_candidate
+         {
+            block_id_type                previous;
+            vector<sealed_transaction>   transactions;
+            size_t                       total_size = 0;
+            /// set once the block is full, or a pushed transaction did not fit in it
+            bool                         closed = false;
+         };
+
+         /**
+          *  @param keep_pending_state also apply the pool transactions left out of the candidate,
+          *  so that the pending state reflects the whole pool until the candidate is used
+          */
+         void _build_block_candidate( bool keep_pending_state );
+         void _extend_block_candidate( const processed_transaction& ptrx );
+
+         pending_transaction_pool               _pending_pool;
+         optional<block_candidate>              _block_candidate;
+         /// pending transactions saved by the last close(), waiting to be pushed again
+         std::deque< signed_transaction >       _saved_pending_tx;
          fork_database                          _fork_db;
 
+         /// checks run by push_block() for the block it is about to apply
+         optional<precomputed_block_checks>     _precomputed_checks;
+         const sealed_block*                    _applying_block = nullptr;
+         bool                                   _track_transaction_conflicts = false;
+         transaction_conflict_stats             _last_block_conflict_stats;
+         bool                                   _speculative_execution = false;
+         speculative_execution_stats            _last_block_speculation_stats;
+         /// objects written by the transactions of the block being applied in speculative mode
+         const std::unordered_set<object_id_type>* _speculation_block_writes = nullptr;
+         block_generation_timings               _last_generation_timings;
+         /// time push_block() spent re-applying the pending transactions after the block
+         fc::microseconds                       _last_pending_restore_time;
+         mutable unique_ptr<thread_pool>        _thread_pool;
+         verified_transaction_cache             _verified_trx_cache;
+         shared_ptr<authority_check_cache>      _authority_cache = std::make_shared<authority_check_cache>();
+         recent_transaction_cache               _recent_trx_cache;
+         operation_profiler                     _operation_profiler;
+         optional<uint32_t>                     _worker_thread_count;
+         /// ids collected for changed_objects_by_block since its last emission
+         vector<object_id_type>                 _block_changed_ids;
+
          /**
           *  Note: we can probably store blocks by block num rather than
           *  block id because after the undo window is past the block ID
@@ -514,3 +796,8 @@ namespace graphene { namespace chain {
    }
 
 } }
+
+FC_REFLECT( graphene::chain::transaction_conflict_stats, (block_num)(transactions)(conflicting)(rounds) )
+FC_REFLECT( graphene::chain::speculative_execution_stats, (block_num)(speculated)(reused)(reevaluated) )
+FC_REFLECT( graphene::chain::block_generation_timings,
+            (block_num)(transactions)(preassembled)(assemble_us)(sign_us)(apply_us)(restore_pending_us)(total_us) )
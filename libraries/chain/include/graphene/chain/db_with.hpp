@@ -25,6 +25,8 @@
 
 #include <graphene/chain/database.hpp>
 
+#include <algorithm>
+
 /*
  * This file provides with() functions which modify the database
  * temporarily, then restore it.  These functions are mostly internal
@@ -68,35 +70,53 @@ struct skip_flags_restorer
  */
 struct pending_transactions_restorer
 {
-   pending_transactions_restorer( database& db, std::vector<processed_transaction>&& pending_transactions )
-      : _db(db), _pending_transactions( std::move(pending_transactions) )
+   pending_transactions_restorer( database& db, std::vector<pending_transaction_pool::entry>&& pending_transactions )
+      : _db(db), _pending_transactions( std::move(pending_transactions) ), _previous_head( db.head_block_id() )
    {
       _db.clear_pending();
    }
 
+   /// true if the transaction accessed none of the objects in @p changed, both sorted
+   static bool is_untouched( const pending_transaction_pool::entry& e, const std::vector<object_id_type>& changed )
+   {
+      if( !e.accessed_objects )
+         return false;
+      for( const object_id_type& id : *e.accessed_objects )
+         if( std::binary_search( changed.begin(), changed.end(), id ) )
+            return false;
+      return true;
+   }
+
    ~pending_transactions_restorer()
    {
+      // Popped transactions change the state the pending transactions were checked against
+      optional< std::vector<object_id_type> > changed;
+      if( _db._popped_tx.empty() )
+         changed = _db._objects_changed_since( _previous_head );
+
       for( const auto& tx : _db._popped_tx )
       {
          try {
             if( !_db.is_known_transaction( tx.id() ) ) {
                // since push_transaction() takes a signed_transaction,
                // the operation_results field will be ignored.
-               _db._push_transaction( tx );
+               _db._push_transaction( tx, true );
             }
          } catch ( const fc::exception&  ) {
          }
       }
       _db._popped_tx.clear();
-      for( const processed_transaction& tx : _pending_transactions )
+      for( pending_transaction_pool::entry& pending : _pending_transactions )
       {
          try
          {
-            if( !_db.is_known_transaction( tx.id() ) ) {
-               // since push_transaction() takes a signed_transaction,
+            if( _db.is_known_transaction( pending.id() ) )
+               continue;
+            if( changed.valid() && is_untouched( pending, *changed ) )
+               _db._carry_over_pending_transaction( std::move(pending) );
+            else
                // the operation_results field will be ignored.
-               _db._push_transaction( tx );
-            }
+               _db._push_transaction( pending.trx, true );
          }
          catch( const fc::exception& e )
          {
@@ -109,7 +129,8 @@ struct pending_transactions_restorer
    }
 
    database& _db;
-   std::vector< processed_transaction > _pending_transactions;
+   std::vector< pending_transaction_pool::entry > _pending_transactions;
+   block_id_type _previous_head;
 };
 
 /**
@@ -134,12 +155,14 @@ void with_skip_flags(
  * Empty pending_transactions, call callback,
  * then reset pending_transactions after callback is done.
  *
- * Pending transactions which no longer validate will be culled.
+ * Pending transactions which no longer validate will be culled.  Those which
+ * accessed none of the objects changed by the block applied in between are
+ * carried over without verifying their signatures and authorities again.
  */
 template< typename Lambda >
 void without_pending_transactions(
    database& db,
-   std::vector<processed_transaction>&& pending_transactions,
+   std::vector<pending_transaction_pool::entry>&& pending_transactions,
    Lambda callback )
 {
     pending_transactions_restorer restorer( db, std::move(pending_transactions) );
@@ -23,6 +23,8 @@
  */
 #pragma once
 #include <graphene/chain/exceptions.hpp>
+#include <graphene/chain/operation_profiler.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/transaction_evaluation_state.hpp>
 #include <graphene/chain/protocol/operations.hpp>
 
@@ -41,6 +43,14 @@ namespace graphene { namespace chain {
       virtual int get_type()const = 0;
       virtual operation_result start_evaluate(transaction_evaluation_state& eval_state, const operation& op, bool apply);
 
+      /**
+       * Runs only the checks of evaluate(), without the profiler, so that it can run on a worker
+       * thread while nothing writes to the database.  apply_evaluated() finishes the operation
+       * later, as long as nothing evaluate() read has changed in between.
+       */
+      void evaluate_only(transaction_evaluation_state& eval_state, const operation& op);
+      operation_result apply_evaluated(transaction_evaluation_state& eval_state, const operation& op);
+
       /**
        * @note derived classes should ASSUME that the default validation that is
        * indepenent of chain state should be performed by op.validate() and should
@@ -106,7 +116,10 @@ namespace graphene { namespace chain {
       // header to call db() without including database.hpp, which would
       // cause a circular dependency
       share_type calculate_fee_for_operation(const operation& op) const;
+      const fee_schedule& current_fee_schedule()const;
       void db_adjust_balance(const account_id_type& fee_payer, asset fee_from_account);
+      /// the database's operation_profiler, or nullptr when profiling is disabled
+      operation_profiler* get_operation_profiler()const;
 
       asset                            fee_from_account;
       share_type                       core_fee_paid;
@@ -115,6 +128,10 @@ namespace graphene { namespace chain {
       const asset_object*              fee_asset          = nullptr;
       const asset_dynamic_data_object* fee_asset_dyn_data = nullptr;
       transaction_evaluation_state*    trx_state;
+
+      operation_profiler*              profiler = nullptr;
+      /// time spent on fee handling by evaluate() and apply(), recorded by start_evaluate()
+      uint64_t                         fee_handling_ns = 0;
    };
 
    class op_evaluator
@@ -122,6 +139,8 @@ namespace graphene { namespace chain {
    public:
       virtual ~op_evaluator(){}
       virtual operation_result evaluate(transaction_evaluation_state& eval_state, const operation& op, bool apply) = 0;
+      /// @see generic_evaluator::evaluate_only()
+      virtual std::shared_ptr<generic_evaluator> evaluate_only(transaction_evaluation_state& eval_state, const operation& op)const = 0;
    };
 
    template<typename T>
@@ -133,6 +152,12 @@ namespace graphene { namespace chain {
          T eval;
          return eval.start_evaluate(eval_state, op, apply);
       }
+      virtual std::shared_ptr<generic_evaluator> evaluate_only(transaction_evaluation_state& eval_state, const operation& op)const override
+      {
+         auto eval = std::make_shared<T>();
+         eval->generic_evaluator::evaluate_only(eval_state, op);
+         return eval;
+      }
    };
 
    template<typename DerivedEvaluator>
@@ -146,16 +171,20 @@ namespace graphene { namespace chain {
          auto* eval = static_cast<DerivedEvaluator*>(this);
          const auto& op = o.get<typename DerivedEvaluator::operation_type>();
 
-         prepare_fee(op.fee_payer(), op.fee);
-         if( !trx_state->skip_fee_schedule_check )
          {
-            share_type required_fee = calculate_fee_for_operation(op);
-            GRAPHENE_ASSERT( core_fee_paid >= required_fee,
-                       insufficient_fee,
-                       "Insufficient Fee Paid",
-                       ("core_fee_paid",core_fee_paid)("required", required_fee) );
+            operation_profiler::accumulating_timer fee_timer( profiler, fee_handling_ns );
+            prepare_fee(op.fee_payer(), op.fee);
+            if( !trx_state->skip_fee_schedule_check )
+            {
+               share_type required_fee = current_fee_schedule().calculate_core_fee(op);
+               GRAPHENE_ASSERT( core_fee_paid >= required_fee,
+                          insufficient_fee,
+                          "Insufficient Fee Paid",
+                          ("core_fee_paid",core_fee_paid)("required", required_fee) );
+            }
          }
 
+         operation_profiler::scoped_timer timer( profiler, get_type(), operation_profiler::evaluate_phase );
          return eval->do_evaluate(op);
       }
 
@@ -164,11 +193,19 @@ namespace graphene { namespace chain {
          auto* eval = static_cast<DerivedEvaluator*>(this);
          const auto& op = o.get<typename DerivedEvaluator::operation_type>();
 
-         convert_fee();
-         pay_fee();
+         {
+            operation_profiler::accumulating_timer fee_timer( profiler, fee_handling_ns );
+            convert_fee();
+            pay_fee();
+         }
 
-         auto result = eval->do_apply(op);
+         operation_result result;
+         {
+            operation_profiler::scoped_timer timer( profiler, get_type(), operation_profiler::apply_phase );
+            result = eval->do_apply(op);
+         }
 
+         operation_profiler::accumulating_timer fee_timer( profiler, fee_handling_ns );
          db_adjust_balance(op.fee_payer(), -fee_from_account);
 
          return result;
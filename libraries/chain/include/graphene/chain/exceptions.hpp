@@ -33,6 +33,23 @@
    FC_MULTILINE_MACRO_END
 
 
+/**
+ * Rethrows the common, cheap rejections of a transaction untouched.  Placed in
+ * front of FC_CAPTURE_AND_RETHROW it keeps that macro from serializing the whole
+ * transaction into the log context of failures that are expected in bulk from
+ * spam: duplicates, expired transactions, missing signatures, insufficient
+ * balance and a full pending pool.
+ */
+#define GRAPHENE_RETHROW_TRANSACTION_REJECTIONS                       \
+   catch( const graphene::chain::duplicate_transaction& ) { throw; }  \
+   catch( const graphene::chain::expired_transaction& ) { throw; }    \
+   catch( const graphene::chain::insufficient_funds& ) { throw; }     \
+   catch( const graphene::chain::tx_missing_active_auth& ) { throw; } \
+   catch( const graphene::chain::tx_missing_owner_auth& ) { throw; }  \
+   catch( const graphene::chain::tx_missing_other_auth& ) { throw; }  \
+   catch( const graphene::chain::pending_pool_full& ) { throw; }      \
+   catch( const graphene::chain::pending_fee_payer_quota& ) { throw; }
+
 #define GRAPHENE_DECLARE_OP_BASE_EXCEPTIONS( op_name )                \
    FC_DECLARE_DERIVED_EXCEPTION(                                      \
       op_name ## _validate_exception,                                 \
@@ -85,6 +102,8 @@ namespace graphene { namespace chain {
    FC_DECLARE_DERIVED_EXCEPTION( tx_duplicate_sig,                  graphene::chain::transaction_exception, 3030005, "duplicate signature included" )
    FC_DECLARE_DERIVED_EXCEPTION( invalid_committee_approval,        graphene::chain::transaction_exception, 3030006, "committee account cannot directly approve transaction" )
    FC_DECLARE_DERIVED_EXCEPTION( insufficient_fee,                  graphene::chain::transaction_exception, 3030007, "insufficient fee" )
+   FC_DECLARE_DERIVED_EXCEPTION( pending_pool_full,                 graphene::chain::transaction_exception, 3030008, "pending transaction pool is full" )
+   FC_DECLARE_DERIVED_EXCEPTION( pending_fee_payer_quota,           graphene::chain::transaction_exception, 3030009, "fee payer is over its pending transaction quota" )
 
    FC_DECLARE_DERIVED_EXCEPTION( invalid_pts_address,               graphene::chain::utility_exception, 3060001, "invalid pts address" )
    FC_DECLARE_DERIVED_EXCEPTION( insufficient_feeds,                graphene::chain::chain_exception, 37006, "insufficient feeds" )
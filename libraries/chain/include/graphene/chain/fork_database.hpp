@@ -39,6 +39,8 @@ namespace graphene { namespace chain {
    {
       fork_item( signed_block d )
       :num(d.block_num()),id(d.id()),data( std::move(d) ){}
+      fork_item( const sealed_block& d )
+      :num(d.block_num()),id(d.id()),data( d.get() ){}
 
       block_id_type previous_id()const { return data.previous; }
 
@@ -86,6 +88,7 @@ namespace graphene { namespace chain {
           *  @return the new head block ( the longest fork )
           */
          shared_ptr<fork_item>            push_block(const signed_block& b);
+         shared_ptr<fork_item>            push_block(const sealed_block& b);
          shared_ptr<fork_item>            head()const { return _head; }
          void                             pop_block();
 
@@ -113,6 +116,7 @@ namespace graphene { namespace chain {
       private:
          /** @return a pointer to the newly pushed item */
          void _push_block(const item_ptr& b );
+         shared_ptr<fork_item> push_item(const item_ptr& item);
          void _push_next(const item_ptr& newly_inserted);
 
          uint32_t                 _max_size = 1024;
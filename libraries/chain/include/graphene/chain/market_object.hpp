@@ -26,14 +26,63 @@
 #include <graphene/chain/protocol/asset.hpp>
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/index.hpp>
 #include <graphene/db/object.hpp>
 
+#include <fc/uint128.hpp>
+
 #include <boost/multi_index/composite_key.hpp>
 
+#include <map>
+
 namespace graphene { namespace chain {
 
 using namespace graphene::db;
 
+/**
+ *  @brief a price with its ratio precomputed, to order the market indexes cheaply
+ *
+ *  Comparing two prices cross-multiplies their amounts in 128 bits.  This key also keeps
+ *  base / quote as a 64.64 fixed point number, computed once when the price is set, so most
+ *  comparisons are a single integer comparison.  The ratio is rounded down, which keeps the
+ *  order of the prices, so only keys with equal ratios compare their exact prices.
+ *
+ *  Keys also compare with plain prices, so the indexes are still searched by price.
+ */
+struct price_sort_key
+{
+   price_sort_key() {}
+   explicit price_sort_key( const price& p );
+
+   price        exact;
+   fc::uint128  ratio;
+};
+
+inline bool operator < ( const price_sort_key& a, const price_sort_key& b )
+{
+   if( a.exact.base.asset_id != b.exact.base.asset_id )
+      return a.exact.base.asset_id < b.exact.base.asset_id;
+   if( a.exact.quote.asset_id != b.exact.quote.asset_id )
+      return a.exact.quote.asset_id < b.exact.quote.asset_id;
+   if( a.ratio != b.ratio )
+      return a.ratio < b.ratio;
+   return a.exact < b.exact;
+}
+inline bool operator < ( const price_sort_key& a, const price& b ) { return a.exact < b; }
+inline bool operator < ( const price& a, const price_sort_key& b ) { return a < b.exact; }
+
+/// compares price_sort_keys with each other and with prices, for the index lookups by price
+struct price_sort_key_less
+{
+   template<typename A, typename B>
+   bool operator()( const A& a, const B& b )const { return a < b; }
+};
+struct price_sort_key_greater
+{
+   template<typename A, typename B>
+   bool operator()( const A& a, const B& b )const { return b < a; }
+};
+
 /**
  *  @brief an offer to sell a amount of a asset at a specified exchange rate by a certain time
  *  @ingroup object
@@ -53,6 +102,12 @@ class limit_order_object : public abstract_object<limit_order_object>
       share_type       for_sale; ///< asset id is sell_price.base.asset_id
       price            sell_price;
       share_type       deferred_fee;
+      /// sell_price as ordered by the by_price index, see update_sort_keys(); not serialized,
+      /// database::open() computes it again
+      price_sort_key   sell_price_key;
+
+      /// must be called whenever sell_price is set
+      void update_sort_keys() { sell_price_key = price_sort_key( sell_price ); }
 
       pair<asset_id_type,asset_id_type> get_market()const
       {
@@ -81,10 +136,10 @@ typedef multi_index_container<
       >,
       ordered_unique< tag<by_price>,
          composite_key< limit_order_object,
-            member< limit_order_object, price, &limit_order_object::sell_price>,
+            member< limit_order_object, price_sort_key, &limit_order_object::sell_price_key>,
             member< object, object_id_type, &object::id>
          >,
-         composite_key_compare< std::greater<price>, std::less<object_id_type> >
+         composite_key_compare< price_sort_key_greater, std::less<object_id_type> >
       >,
       ordered_unique< tag<by_account>,
          composite_key< limit_order_object,
@@ -97,6 +152,49 @@ typedef multi_index_container<
 
 typedef generic_index<limit_order_object, limit_order_multi_index_type> limit_order_index;
 
+/**
+ *  @brief This secondary index sums the limit orders of each market into price levels.
+ *
+ *  A level holds the orders selling the same asset for the same other asset at the same price,
+ *  so an order book of any depth is read without visiting every order.  Prices are compared by
+ *  value: orders at 1/2 and at 2/4 share a level.  Amounts are summed exactly, each order
+ *  contributing what it would receive rounded down, as amount_to_receive() does.
+ */
+class limit_order_price_level_index : public secondary_index
+{
+   public:
+      struct price_level
+      {
+         /// price of the first order of the level, base is the asset sold
+         price         sell_price;
+         /// sum of the amounts for sale, in sell_price.base
+         fc::uint128   for_sale;
+         /// sum of the amounts the orders would receive, in sell_price.quote
+         fc::uint128   to_receive;
+         uint32_t      order_count = 0;
+      };
+      /// same order as the by_price index of limit_order_index
+      typedef std::map< price_sort_key, price_level, price_sort_key_greater > level_map;
+
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after ) override;
+
+      /** @return the range of levels selling @p sell for @p receive, best price first */
+      std::pair< level_map::const_iterator, level_map::const_iterator > get_levels( asset_id_type sell, asset_id_type receive )const
+      {
+         return std::make_pair( _levels.lower_bound( price_sort_key( price::max( sell, receive ) ) ),
+                                _levels.upper_bound( price_sort_key( price::min( sell, receive ) ) ) );
+      }
+
+   private:
+      void add_order( const limit_order_object& o );
+      void remove_order( const limit_order_object& o );
+
+      level_map _levels;
+};
+
 /**
  * @class call_order_object
  * @brief tracks debt and call price information
@@ -120,6 +218,17 @@ class call_order_object : public abstract_object<call_order_object>
       share_type       collateral;  ///< call_price.base.asset_id, access via get_collateral
       share_type       debt;        ///< call_price.quote.asset_id, access via get_collateral
       price            call_price;  ///< Debt / Collateral
+      /// call_price and collateralization() as ordered by the indexes, see update_sort_keys();
+      /// not serialized, database::open() computes them again
+      price_sort_key   call_price_key;
+      price_sort_key   collateralization_key;
+
+      /// must be called whenever the collateral, the debt or call_price change
+      void update_sort_keys()
+      {
+         call_price_key = price_sort_key( call_price );
+         collateralization_key = price_sort_key( collateralization() );
+      }
 };
 
 /**
@@ -152,10 +261,10 @@ typedef multi_index_container<
          member< object, object_id_type, &object::id > >,
       ordered_unique< tag<by_price>,
          composite_key< call_order_object,
-            member< call_order_object, price, &call_order_object::call_price>,
+            member< call_order_object, price_sort_key, &call_order_object::call_price_key>,
             member< object, object_id_type, &object::id>
          >,
-         composite_key_compare< std::less<price>, std::less<object_id_type> >
+         composite_key_compare< price_sort_key_less, std::less<object_id_type> >
       >,
       ordered_unique< tag<by_account>,
          composite_key< call_order_object,
@@ -165,9 +274,10 @@ typedef multi_index_container<
       >,
       ordered_unique< tag<by_collateral>,
          composite_key< call_order_object,
-            const_mem_fun< call_order_object, price, &call_order_object::collateralization >,
+            member< call_order_object, price_sort_key, &call_order_object::collateralization_key >,
             member< object, object_id_type, &object::id >
-         >
+         >,
+         composite_key_compare< price_sort_key_less, std::less<object_id_type> >
       >
    >
 > call_order_multi_index_type;
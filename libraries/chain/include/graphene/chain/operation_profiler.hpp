@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/chain/protocol/operations.hpp>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief call counts and latency histograms of the evaluators, per operation type
+    *
+    *  When enabled, every evaluator records how long its do_evaluate() and do_apply() took
+    *  and how long the fee handling around them (prepare_fee(), the minimum fee check,
+    *  convert_fee(), pay_fee() and the final balance adjustment) took.  Latencies are kept in
+    *  power of two buckets of nanoseconds, bucket i counting samples in [2^i, 2^(i+1)) ns.
+    *
+    *  When disabled the evaluators only test a pointer.  record() may be called from any
+    *  thread.
+    */
+   class operation_profiler
+   {
+      public:
+         enum phase
+         {
+            fee_phase,
+            evaluate_phase,
+            apply_phase,
+            phase_count
+         };
+
+         static const uint32_t bucket_count = 32;
+
+         struct histogram
+         {
+            uint64_t          count    = 0;
+            uint64_t          total_ns = 0;
+            uint64_t          max_ns   = 0;
+            vector<uint64_t>  buckets;
+         };
+
+         struct operation_stats
+         {
+            int32_t    operation_tag = 0;
+            string     operation_name;
+            histogram  fee;
+            histogram  evaluate;
+            histogram  apply;
+         };
+
+         /// records the time from construction to destruction, does nothing without a profiler
+         class scoped_timer
+         {
+            public:
+               scoped_timer( operation_profiler* p, int tag, phase ph )
+               : _profiler(p), _tag(tag), _phase(ph)
+               {
+                  if( _profiler ) _start = std::chrono::steady_clock::now();
+               }
+               ~scoped_timer()
+               {
+                  if( _profiler ) _profiler->record( _tag, _phase, elapsed_ns( _start ) );
+               }
+            private:
+               operation_profiler*                    _profiler;
+               int                                    _tag;
+               phase                                  _phase;
+               std::chrono::steady_clock::time_point  _start;
+         };
+
+         /// adds the time from construction to destruction to a running total
+         class accumulating_timer
+         {
+            public:
+               accumulating_timer( const operation_profiler* p, uint64_t& total )
+               : _enabled( p != nullptr ), _total(total)
+               {
+                  if( _enabled ) _start = std::chrono::steady_clock::now();
+               }
+               ~accumulating_timer()
+               {
+                  if( _enabled ) _total += elapsed_ns( _start );
+               }
+            private:
+               bool                                   _enabled;
+               uint64_t&                              _total;
+               std::chrono::steady_clock::time_point  _start;
+         };
+
+         operation_profiler();
+
+         void enable( bool e ) { _enabled = e; }
+         bool enabled()const   { return _enabled; }
+
+         void record( int tag, phase ph, uint64_t ns );
+         void reset();
+
+         /// statistics of every operation type which was evaluated at least once
+         vector<operation_stats> get_stats()const;
+         /// one line per operation type, sorted by the total time spent in it
+         string report()const;
+
+         static uint64_t elapsed_ns( const std::chrono::steady_clock::time_point& start )
+         {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+         }
+
+      private:
+         struct phase_data
+         {
+            uint64_t                            count    = 0;
+            uint64_t                            total_ns = 0;
+            uint64_t                            max_ns   = 0;
+            std::array<uint64_t, bucket_count>  buckets  = {};
+         };
+         typedef std::array<phase_data, phase_count> operation_data;
+
+         histogram to_histogram( const phase_data& d )const;
+
+         bool                    _enabled = false;
+         mutable std::mutex      _mutex;
+         vector<operation_data>  _data;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::operation_profiler::histogram, (count)(total_ns)(max_ns)(buckets) )
+FC_REFLECT( graphene::chain::operation_profiler::operation_stats, (operation_tag)(operation_name)(fee)(evaluate)(apply) )
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/chain/protocol/transaction.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include <functional>
+#include <map>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief the transactions pushed since the head block, waiting to be included in a block
+    *
+    *  Entries keep the order they arrived in, which is the order they were applied to the
+    *  pending state, and are also indexed by id, expiration, fee payer and fee density: the
+    *  core value of their fees per kilobyte of their packed size.
+    *
+    *  The pool is bounded by a number of transactions and a number of bytes.  Once it is full,
+    *  a transaction is only admitted if it pays a higher fee density than the entries it would
+    *  evict, lowest paying and most recent first.  Each fee payer can also be held to a smaller
+    *  quota of transactions and bytes, so that a single account cannot fill the pool.
+    *
+    *  Eviction only drops a transaction from the pool; its effects stay in the pending state
+    *  until that state is rebuilt after the next block.  A block is produced by re-applying the
+    *  transactions of the pool, unless the database prepared a block candidate ahead of the
+    *  slot: the block is then the candidate, which holds the transactions picked from the pool
+    *  when it was prepared and those appended to it as they were pushed, without applying them
+    *  again.  Such a block can include a transaction the pool evicted after it entered the
+    *  candidate; it was applied on top of the earlier ones and is still valid there.
+    */
+   class pending_transaction_pool
+   {
+      public:
+         struct entry
+         {
+            sealed_transaction trx;
+            account_id_type    fee_payer;
+            share_type         core_fee;
+            uint32_t           size = 0;
+            /// core fee paid per kilobyte of packed transaction
+            int64_t            fee_density = 0;
+            /// position in arrival order, breaks fee density ties
+            uint64_t           sequence = 0;
+            /// sorted ids of the objects read or written while the transaction was applied
+            std::shared_ptr<const vector<object_id_type>> accessed_objects;
+
+            const transaction_id_type& id()const { return trx.id(); }
+            time_point_sec             expiration()const { return trx.get().expiration; }
+         };
+
+         struct by_trx_id;
+         struct by_expiration;
+         struct by_fee_density;
+         struct by_fee_payer;
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::sequenced<>,
+               boost::multi_index::hashed_unique< boost::multi_index::tag<by_trx_id>,
+                  boost::multi_index::const_mem_fun< entry, const transaction_id_type&, &entry::id >,
+                  std::hash<transaction_id_type> >,
+               boost::multi_index::ordered_non_unique< boost::multi_index::tag<by_expiration>,
+                  boost::multi_index::const_mem_fun< entry, time_point_sec, &entry::expiration > >,
+               /// lowest value first: lowest fee density, then most recent
+               boost::multi_index::ordered_unique< boost::multi_index::tag<by_fee_density>,
+                  boost::multi_index::composite_key< entry,
+                     boost::multi_index::member< entry, int64_t, &entry::fee_density >,
+                     boost::multi_index::member< entry, uint64_t, &entry::sequence >
+                  >,
+                  boost::multi_index::composite_key_compare< std::less<int64_t>, std::greater<uint64_t> >
+               >,
+               /// arrival order within each fee payer
+               boost::multi_index::ordered_unique< boost::multi_index::tag<by_fee_payer>,
+                  boost::multi_index::composite_key< entry,
+                     boost::multi_index::member< entry, account_id_type, &entry::fee_payer >,
+                     boost::multi_index::member< entry, uint64_t, &entry::sequence >
+                  >
+               >
+            >
+         > index_type;
+
+         struct stats
+         {
+            uint32_t size      = 0;
+            uint64_t bytes     = 0;
+            uint32_t max_size  = 0;
+            uint64_t max_bytes = 0;
+            /// transactions admitted, evicted for better paying ones, dropped at expiration
+            /// and refused because the pool was full
+            uint64_t added     = 0;
+            uint64_t evicted   = 0;
+            uint64_t expired   = 0;
+            uint64_t refused   = 0;
+            /// transactions kept across a block without being verified again
+            uint64_t carried_over = 0;
+            /// quota of each fee payer, zero when unlimited
+            uint32_t max_size_per_fee_payer  = 0;
+            uint64_t max_bytes_per_fee_payer = 0;
+            /// transactions refused because their fee payer was over its quota
+            uint64_t over_quota = 0;
+         };
+
+         explicit pending_transaction_pool( uint32_t max_size = 100000, uint64_t max_bytes = 64 * 1024 * 1024 )
+            : _max_size( max_size ), _max_bytes( max_bytes ) {}
+
+         static int64_t fee_density( share_type core_fee, uint32_t size );
+
+         /**
+          *  Whether a transaction of this fee density and size fits, possibly by evicting lower
+          *  paying entries.  Counts a refusal when it does not.
+          */
+         bool can_admit( int64_t fee_density, uint32_t size );
+         /**
+          *  Whether @p fee_payer may add a transaction of @p size without going over its quota.
+          *  Counts a refusal when it may not.
+          */
+         bool within_fee_payer_quota( account_id_type fee_payer, uint32_t size );
+
+         /**
+          *  Adds a transaction which was applied to the pending state, then evicts the lowest
+          *  paying entries while the pool is over its limits.
+          *
+          *  @return the ids of the evicted transactions
+          */
+         vector<transaction_id_type> add( const sealed_transaction& trx, account_id_type fee_payer, share_type core_fee,
+                                          std::shared_ptr<const vector<object_id_type>> accessed_objects =
+                                             std::shared_ptr<const vector<object_id_type>>() );
+         /**
+          *  Adds back an entry returned by take_all() whose transaction was applied to the new
+          *  pending state without being verified again, at the end of the arrival order.
+          */
+         vector<transaction_id_type> carry_over( entry e );
+
+         /// removes the entries which expired before @p now, returns how many
+         uint32_t remove_expired( time_point_sec now );
+         bool     remove( const transaction_id_type& id );
+         /// empties the pool and returns its entries in arrival order
+         vector<entry> take_all();
+         void     clear();
+
+         optional<sealed_transaction> find( const transaction_id_type& id )const;
+         bool     contains( const transaction_id_type& id )const;
+         uint32_t count_by_fee_payer( account_id_type payer )const;
+
+         /**
+          *  Visits the entries in the order a block should include them: the highest fee density
+          *  first, except that the entries of one fee payer keep their arrival order, since a
+          *  transaction may depend on an earlier one of the same account.  When @p visit returns
+          *  false, the remaining entries of that fee payer are not visited.
+          */
+         void for_each_by_value( const std::function<bool(const entry&)>& visit )const;
+
+         /// all entries, iterated in arrival order; the other orders are available through get<>()
+         const index_type& entries()const { return _entries; }
+         size_t   size()const  { return _entries.size(); }
+         uint64_t bytes()const { return _bytes; }
+         bool     empty()const { return _entries.empty(); }
+
+         void  set_limits( uint32_t max_size, uint64_t max_bytes );
+         /// zero leaves the number of transactions or of bytes of a fee payer unlimited
+         void  set_fee_payer_quota( uint32_t max_size, uint64_t max_bytes );
+         /// fee payers which are not held to the quota, such as the accounts of this node
+         void  set_quota_exempt_fee_payers( flat_set<account_id_type> exempt );
+         stats get_stats()const;
+
+      private:
+         struct fee_payer_usage
+         {
+            uint32_t count = 0;
+            uint64_t bytes = 0;
+         };
+
+         /// false if the transaction is already in the pool
+         bool                        insert( entry&& e );
+         vector<transaction_id_type> evict();
+         /// updates the totals for an entry about to be erased
+         void                        forget( const entry& e );
+
+         index_type _entries;
+         uint64_t   _bytes = 0;
+         uint64_t   _next_sequence = 0;
+         uint32_t   _max_size;
+         uint64_t   _max_bytes;
+         uint32_t   _max_size_per_fee_payer = 0;
+         uint64_t   _max_bytes_per_fee_payer = 0;
+         flat_set<account_id_type> _quota_exempt_fee_payers;
+         /// transactions and bytes of each fee payer in the pool
+         std::map<account_id_type, fee_payer_usage> _fee_payer_usage;
+         stats      _stats;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::pending_transaction_pool::stats,
+            (size)(bytes)(max_size)(max_bytes)(added)(evicted)(expired)(refused)(carried_over)
+            (max_size_per_fee_payer)(max_bytes_per_fee_payer)(over_quota) )
@@ -49,10 +49,62 @@ namespace graphene { namespace chain {
       signature_type             witness_signature;
    };
 
+   /// runs f(i) for every i in [0, count), possibly in parallel
+   typedef std::function< void( size_t count, const std::function<void(size_t)>& f ) > for_each_index_type;
+
    struct signed_block : public signed_block_header
    {
       checksum_type calculate_merkle_root()const;
+      /** Computes the leaves and the wide levels of the tree through for_each, the result is the same */
+      checksum_type calculate_merkle_root( const for_each_index_type& for_each )const;
       vector<processed_transaction> transactions;
+
+      /// computes the merkle root from the merkle_digest() of each transaction
+      static checksum_type calculate_merkle_root( vector<digest_type> leaves );
+      static checksum_type calculate_merkle_root( vector<digest_type> leaves, const for_each_index_type& for_each );
+   };
+
+   /**
+    *  @brief a signed_block that can no longer change, with its id, digest, packed size and
+    *  sealed transactions computed only once
+    *
+    *  Like sealed_transaction, the block can only be read through get() and must be copied out
+    *  and sealed again to change it.
+    */
+   class sealed_block
+   {
+      public:
+         typedef for_each_index_type for_each_type;
+
+         sealed_block( signed_block b, const chain_id_type& chain_id );
+         /** Seals the transactions through for_each, so the caller can spread the work over several threads */
+         sealed_block( signed_block b, const chain_id_type& chain_id, const for_each_type& for_each );
+         /** Uses transactions that were sealed already, they must be the transactions of b in the same order */
+         sealed_block( signed_block b, vector<sealed_transaction> transactions );
+
+         const signed_block& get()const                            { return *_block; }
+         operator const signed_block&()const                      { return *_block; }
+         uint32_t            block_num()const                      { return _block->block_num(); }
+
+         const block_id_type& id()const                            { return _id; }
+         /// digest of the block header, which is signed by the witness
+         const digest_type&   digest()const                        { return _digest; }
+         size_t               packed_size()const                   { return _packed_size; }
+
+         const vector<sealed_transaction>& transactions()const     { return _transactions; }
+
+         checksum_type        calculate_merkle_root()const;
+         checksum_type        calculate_merkle_root( const for_each_type& for_each )const;
+         fc::ecc::public_key  signee()const;
+
+      private:
+         void seal_header();
+
+         shared_ptr<const signed_block>    _block;
+         vector<sealed_transaction>        _transactions;
+         block_id_type                     _id;
+         digest_type                       _digest;
+         size_t                            _packed_size = 0;
    };
 
 } } // graphene::chain
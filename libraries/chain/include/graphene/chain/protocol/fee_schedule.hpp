@@ -50,6 +50,29 @@ namespace graphene { namespace chain {
       asset calculate_fee( const operation& op, const price& core_exchange_rate = price::unit_price() )const;
       asset set_fee( operation& op, const price& core_exchange_rate = price::unit_price() )const;
 
+      /**
+       *  Calculates the fee of an operation in CORE without wrapping it into an operation,
+       *  same as calculate_fee( op ).amount.
+       */
+      template<typename Operation>
+      share_type calculate_core_fee( const Operation& op )const
+      {
+         typedef typename Operation::fee_parameters_type parameters_type;
+         const fee_parameters* params = find_parameters( operation::tag<Operation>::value );
+         if( params == nullptr )
+            return scale_fee( op.calculate_fee( parameters_type() ).value );
+         return scale_fee( op.calculate_fee( params->template get<parameters_type>() ).value );
+      }
+
+      /**
+       *  Resolves the parameters of every operation type into a table indexed by the
+       *  operation tag, so calculating a fee does not search parameters.  The table is
+       *  dropped by the non-const accessors; without it parameters is searched.  The
+       *  database keeps a table for the current fee schedule.
+       */
+      void build_lookup_table()const;
+      bool has_lookup_table()const { return _lookup_table != nullptr; }
+
       void zero_all_fees();
 
       /**
@@ -67,6 +90,7 @@ namespace graphene { namespace chain {
       template<typename Operation>
       typename Operation::fee_parameters_type& get()
       {
+         _lookup_table.reset();
          auto itr = parameters.find( typename Operation::fee_parameters_type() );
          FC_ASSERT( itr != parameters.end() );
          return itr->template get<typename Operation::fee_parameters_type>();
@@ -77,6 +101,14 @@ namespace graphene { namespace chain {
        */
       flat_set<fee_parameters> parameters;
       uint32_t                 scale = GRAPHENE_100_PERCENT; ///< fee * scale / GRAPHENE_100_PERCENT
+
+   private:
+      /// @return the parameters of the operation with this tag, or nullptr if they are not set
+      const fee_parameters* find_parameters( int tag )const;
+      share_type            scale_fee( uint64_t base_value )const;
+
+      /// parameters resolved by operation tag, shared by copies of this schedule
+      mutable std::shared_ptr< const vector<fee_parameters> > _lookup_table;
    };
 
    typedef fee_schedule fee_schedule_type;
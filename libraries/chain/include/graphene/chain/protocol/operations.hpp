@@ -115,6 +115,10 @@ namespace graphene { namespace chain {
 
    void operation_validate( const operation& op );
 
+   /// the fee offered by @p op and the account paying it
+   asset           operation_get_fee( const operation& op );
+   account_id_type operation_get_fee_payer( const operation& op );
+
    /**
     *  @brief necessary to support nested operations inside the proposal_create_operation
     */
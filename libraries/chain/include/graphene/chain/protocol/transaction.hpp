@@ -154,7 +154,8 @@ namespace graphene { namespace chain {
        * This is a slower replacement for get_required_signatures()
        * which returns a minimal set in all cases, including
        * some cases where get_required_signatures() returns a
-       * non-minimal set.
+       * non-minimal set.  No key in the result can be removed
+       * without losing authority.
        */
 
       set<public_key_type> minimize_required_signatures(
@@ -204,6 +205,60 @@ namespace graphene { namespace chain {
       digest_type merkle_digest()const;
    };
 
+   /**
+    *  @brief a processed_transaction that can no longer change, with the values derived from its
+    *  serialization computed only once
+    *
+    *  id(), digest(), sig_digest(), merkle_digest() and fc::raw::pack_size() each serialize the
+    *  whole transaction again on every call.  Sealing packs it once and derives all of them from
+    *  the same bytes: a derived struct packs as its base followed by its own members, so the
+    *  packed transaction and signed_transaction are prefixes of the packed processed_transaction.
+    *
+    *  The transaction can only be read through get().  To change it, copy it out and seal the
+    *  modified copy, so the computed values can never go stale.  Copies of a sealed_transaction
+    *  share the same immutable data.
+    */
+   class sealed_transaction
+   {
+      public:
+         sealed_transaction( processed_transaction trx, const chain_id_type& chain_id );
+         /** Seals a transaction owned by someone else, such as a transaction of a sealed_block */
+         sealed_transaction( shared_ptr<const processed_transaction> trx, const chain_id_type& chain_id );
+
+         const processed_transaction& get()const                    { return *_trx; }
+         operator const processed_transaction&()const              { return *_trx; }
+
+         const transaction_id_type& id()const                      { return _data->id; }
+         const digest_type&         digest()const                  { return _data->digest; }
+         const digest_type&         sig_digest()const              { return _data->sig_digest; }
+         const digest_type&         merkle_digest()const           { return _data->merkle_digest; }
+
+         /// the packed processed_transaction
+         const vector<char>&        packed()const                  { return _data->packed; }
+         size_t                     packed_size()const             { return _data->packed.size(); }
+         /// size of the packed signed_transaction, which is a prefix of packed()
+         size_t                     signed_packed_size()const      { return _data->signed_size; }
+
+         /// same as signed_transaction::get_signature_keys(), without computing the digest again
+         flat_set<public_key_type>  get_signature_keys()const;
+
+      private:
+         struct sealed_data
+         {
+            vector<char>          packed;
+            size_t                signed_size = 0;
+            transaction_id_type   id;
+            digest_type           digest;
+            digest_type           sig_digest;
+            digest_type           merkle_digest;
+         };
+
+         void seal( const chain_id_type& chain_id );
+
+         shared_ptr<const processed_transaction> _trx;
+         shared_ptr<const sealed_data>           _data;
+   };
+
    /// @} transactions group
 
 } } // graphene::chain
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/chain/protocol/transaction.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief keeps the bodies of the most recently applied transactions
+    *
+    *  The transaction_object index only remembers the id, expiration and block number of
+    *  the transactions it deduplicates.  Peers and API clients asking for a recent
+    *  transaction almost always ask for one which was just broadcast, so the newest
+    *  bodies are kept here; older ones are read back from their block.
+    *
+    *  Entries hold their own copy of the signed_transaction.  A sealed_transaction taken from
+    *  a block shares the whole block, so keeping it would pin every block with a cached
+    *  transaction in memory.  The cache is bounded, the oldest entries are evicted first.
+    *
+    *  Only used from the thread which applies transactions, so it does no locking.
+    */
+   class recent_transaction_cache
+   {
+      public:
+         struct stats
+         {
+            uint64_t hits      = 0;
+            uint64_t misses    = 0;
+            uint32_t size      = 0;
+            uint32_t max_size  = 0;
+         };
+
+         explicit recent_transaction_cache( uint32_t max_size = 2000 ) : _max_size( max_size ) {}
+
+         optional<signed_transaction> find( const transaction_id_type& id )const;
+         void                         insert( const sealed_transaction& trx );
+
+         void  set_max_size( uint32_t max_size );
+         void  clear();
+         stats get_stats()const;
+
+      private:
+         struct entry
+         {
+            transaction_id_type   id;
+            signed_transaction    trx;
+         };
+
+         struct by_trx_id;
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::sequenced<>,
+               boost::multi_index::hashed_unique< boost::multi_index::tag<by_trx_id>,
+                  boost::multi_index::member< entry, transaction_id_type, &entry::id >,
+                  std::hash<transaction_id_type> >
+            >
+         > entry_index_type;
+
+         void evict();
+
+         entry_index_type       _entries;
+         uint32_t               _max_size;
+         mutable stats          _stats;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::recent_transaction_cache::stats, (hits)(misses)(size)(max_size) )
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief a fixed set of OS threads used to run stateless work (signature recovery,
+    *  validation, hashing) in parallel with the thread that owns the database.
+    *
+    *  Unlike fc::thread::async(), waiting on the pool blocks the calling thread without
+    *  yielding to other fc tasks, so no other code can touch the database while a block
+    *  is in the middle of being applied.
+    *
+    *  parallel_for() must not be called from one of the pool's own threads.
+    */
+   class thread_pool
+   {
+      public:
+         /** @param thread_count number of worker threads, 0 runs everything on the calling thread */
+         explicit thread_pool( uint32_t thread_count );
+         ~thread_pool();
+
+         uint32_t thread_count()const { return _threads.size(); }
+
+         /**
+          *  Calls f(i) for every i in [0, count), spreading the calls over the worker
+          *  threads and the calling thread, and returns once all of them are done.
+          *
+          *  If any call throws, the remaining calls still run and the first exception
+          *  is rethrown on the calling thread.
+          */
+         void parallel_for( size_t count, const std::function<void(size_t)>& f );
+
+      private:
+         void worker_loop();
+
+         std::vector<std::thread>            _threads;
+         std::mutex                          _mutex;
+         std::condition_variable             _condition;
+         std::deque< std::function<void()> > _tasks;
+         bool                                _stopping = false;
+   };
+
+} } // graphene::chain
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/chain/protocol/transaction.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+
+#include <mutex>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief remembers transactions which passed the stateless checks
+    *
+    *  A transaction is fully checked when it is pushed from the network, and then again
+    *  when it is included in a block and once more when a witness builds its block.  The
+    *  result of validate() and the keys recovered from the signatures only depend on the
+    *  bytes of the transaction, so they are kept here, keyed by the signature digest, and
+    *  reused by later checks.
+    *
+    *  Authority checks depend on chain state and are not cached here; they are re-run against
+    *  the cached keys, see authority_check_cache.  Because of that no entry ever needs to be
+    *  invalidated when an account's authorities change.
+    *
+    *  The cache is bounded, the oldest entries are evicted first.  find() may be called
+    *  from worker threads.
+    */
+   class verified_transaction_cache
+   {
+      public:
+         struct stats
+         {
+            uint64_t hits      = 0;
+            uint64_t misses    = 0;
+            uint64_t evictions = 0;
+            uint32_t size      = 0;
+            uint32_t max_size  = 0;
+         };
+
+         explicit verified_transaction_cache( uint32_t max_size = 20000 ) : _max_size( max_size ) {}
+
+         /**
+          *  @return the signature keys of a transaction which passed validate(), if the
+          *  transaction with this signature digest and these signatures was seen before
+          */
+         optional< flat_set<public_key_type> > find( const digest_type& sig_digest,
+                                                     const vector<signature_type>& signatures )const;
+
+         /** Records a transaction which passed validate() and whose keys were recovered */
+         void insert( const digest_type& sig_digest, const vector<signature_type>& signatures,
+                      const flat_set<public_key_type>& signature_keys );
+
+         void  set_max_size( uint32_t max_size );
+         void  clear();
+         stats get_stats()const;
+
+      private:
+         struct entry
+         {
+            digest_type                sig_digest;
+            vector<signature_type>     signatures;
+            flat_set<public_key_type>  signature_keys;
+         };
+
+         struct by_digest;
+         typedef boost::multi_index_container<
+            entry,
+            boost::multi_index::indexed_by<
+               boost::multi_index::sequenced<>,
+               boost::multi_index::hashed_unique< boost::multi_index::tag<by_digest>,
+                  boost::multi_index::member< entry, digest_type, &entry::sig_digest >, std::hash<digest_type> >
+            >
+         > entry_index_type;
+
+         void evict();
+
+         mutable std::mutex     _mutex;
+         entry_index_type       _entries;
+         uint32_t               _max_size;
+         mutable stats          _stats;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::verified_transaction_cache::stats, (hits)(misses)(evictions)(size)(max_size) )
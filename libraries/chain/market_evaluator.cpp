@@ -87,6 +87,7 @@ object_id_type limit_order_create_evaluator::do_apply(const limit_order_create_o
        obj.sell_price = op.get_price();
        obj.expiration = op.expiration;
        obj.deferred_fee = _deferred_fee;
+       obj.update_sort_keys();
    });
    limit_order_id_type order_id = new_order_object.id; // save this because we may remove the object by filling it
    bool filled = db().apply_order(new_order_object);
@@ -208,7 +209,7 @@ void_result call_order_update_evaluator::do_apply(const call_order_update_operat
          call.debt = o.delta_debt.amount;
          call.call_price = price::call_price(o.delta_debt, o.delta_collateral,
                                              _bitasset_data->current_feed.maintenance_collateral_ratio);
-
+         call.update_sort_keys();
       });
    }
    else
@@ -223,6 +224,7 @@ void_result call_order_update_evaluator::do_apply(const call_order_update_operat
              call.call_price  =  price::call_price(call.get_debt(), call.get_collateral(),
                                                    _bitasset_data->current_feed.maintenance_collateral_ratio);
           }
+          call.update_sort_keys();
       });
    }
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/market_object.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace chain {
+
+price_sort_key::price_sort_key( const price& p )
+: exact( p )
+{
+   // a price receiving nothing is infinite, as operator< of price treats it
+   if( p.quote.amount.value <= 0 )
+      ratio = fc::uint128::max_value();
+   else
+      ratio = fc::uint128( uint64_t( std::max<int64_t>( p.base.amount.value, 0 ) ), 0 ) / uint64_t( p.quote.amount.value );
+}
+
+namespace {
+   fc::uint128 order_to_receive( const limit_order_object& o )
+   {
+      // asset * price would assert instead of returning amounts above the maximum supply
+      return fc::uint128( uint64_t( o.for_sale.value ) ) * uint64_t( o.sell_price.quote.amount.value )
+             / uint64_t( o.sell_price.base.amount.value );
+   }
+}
+
+void limit_order_price_level_index::add_order( const limit_order_object& o )
+{
+   auto itr = _levels.find( o.sell_price_key );
+   if( itr == _levels.end() )
+   {
+      itr = _levels.emplace( o.sell_price_key, price_level() ).first;
+      itr->second.sell_price = o.sell_price;
+   }
+   price_level& level = itr->second;
+   level.for_sale += uint64_t( o.for_sale.value );
+   level.to_receive += order_to_receive( o );
+   ++level.order_count;
+}
+
+void limit_order_price_level_index::remove_order( const limit_order_object& o )
+{
+   auto itr = _levels.find( o.sell_price_key );
+   assert( itr != _levels.end() );
+   if( itr == _levels.end() )
+      return;
+   price_level& level = itr->second;
+   if( --level.order_count == 0 )
+   {
+      _levels.erase( itr );
+      return;
+   }
+   level.for_sale -= uint64_t( o.for_sale.value );
+   level.to_receive -= order_to_receive( o );
+}
+
+void limit_order_price_level_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const limit_order_object*>(&obj) ); // for debug only
+   add_order( static_cast<const limit_order_object&>(obj) );
+}
+
+void limit_order_price_level_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const limit_order_object*>(&obj) ); // for debug only
+   remove_order( static_cast<const limit_order_object&>(obj) );
+}
+
+void limit_order_price_level_index::about_to_modify( const object& before )
+{
+   assert( dynamic_cast<const limit_order_object*>(&before) ); // for debug only
+   remove_order( static_cast<const limit_order_object&>(before) );
+}
+
+void limit_order_price_level_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const limit_order_object*>(&after) ); // for debug only
+   add_order( static_cast<const limit_order_object&>(after) );
+}
+
+} } // graphene::chain
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/operation_profiler.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace graphene { namespace chain {
+
+namespace {
+   struct operation_name_visitor
+   {
+      typedef string result_type;
+      template<typename Op>
+      string operator()( const Op& )const { return fc::get_typename<Op>::name(); }
+   };
+
+   uint32_t bucket_of( uint64_t ns )
+   {
+      uint32_t bucket = 0;
+      while( ns > 1 && bucket + 1 < operation_profiler::bucket_count )
+      {
+         ns >>= 1;
+         ++bucket;
+      }
+      return bucket;
+   }
+}
+
+operation_profiler::operation_profiler()
+: _data( operation::count() )
+{
+}
+
+void operation_profiler::record( int tag, phase ph, uint64_t ns )
+{
+   if( tag < 0 || size_t(tag) >= _data.size() )
+      return;
+   std::unique_lock<std::mutex> lock( _mutex );
+   phase_data& d = _data[tag][ph];
+   ++d.count;
+   d.total_ns += ns;
+   d.max_ns = std::max( d.max_ns, ns );
+   ++d.buckets[ bucket_of( ns ) ];
+}
+
+void operation_profiler::reset()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   for( auto& op : _data )
+      op = operation_data();
+}
+
+operation_profiler::histogram operation_profiler::to_histogram( const phase_data& d )const
+{
+   histogram h;
+   h.count = d.count;
+   h.total_ns = d.total_ns;
+   h.max_ns = d.max_ns;
+   h.buckets.assign( d.buckets.begin(), d.buckets.end() );
+   // trailing empty buckets carry no information
+   while( !h.buckets.empty() && h.buckets.back() == 0 )
+      h.buckets.pop_back();
+   return h;
+}
+
+vector<operation_profiler::operation_stats> operation_profiler::get_stats()const
+{
+   vector<operation_stats> result;
+   std::unique_lock<std::mutex> lock( _mutex );
+   for( size_t tag = 0; tag < _data.size(); ++tag )
+   {
+      const operation_data& d = _data[tag];
+      if( d[fee_phase].count == 0 && d[evaluate_phase].count == 0 && d[apply_phase].count == 0 )
+         continue;
+      operation op;
+      op.set_which( tag );
+      operation_stats s;
+      s.operation_tag = tag;
+      s.operation_name = op.visit( operation_name_visitor() );
+      s.fee = to_histogram( d[fee_phase] );
+      s.evaluate = to_histogram( d[evaluate_phase] );
+      s.apply = to_histogram( d[apply_phase] );
+      result.push_back( std::move(s) );
+   }
+   return result;
+}
+
+string operation_profiler::report()const
+{
+   auto stats = get_stats();
+   auto total = []( const operation_stats& s ) { return s.fee.total_ns + s.evaluate.total_ns + s.apply.total_ns; };
+   std::sort( stats.begin(), stats.end(), [&]( const operation_stats& a, const operation_stats& b ) {
+      return total(a) > total(b);
+   });
+
+   auto mean_us = []( const histogram& h ) { return h.count ? double(h.total_ns) / h.count / 1000 : 0.0; };
+   std::stringstream ss;
+   ss << "operation                                        count   total ms   fee us  eval us  apply us   max us\n";
+   for( const auto& s : stats )
+   {
+      ss << std::left << std::setw(45) << s.operation_name << std::right
+         << std::setw(10) << s.evaluate.count
+         << std::setw(11) << std::fixed << std::setprecision(1) << total(s) / 1000000.0
+         << std::setw(9)  << mean_us( s.fee )
+         << std::setw(9)  << mean_us( s.evaluate )
+         << std::setw(10) << mean_us( s.apply )
+         << std::setw(9)  << std::max( s.evaluate.max_ns, s.apply.max_ns ) / 1000.0
+         << "\n";
+   }
+   return ss.str();
+}
+
+} } // graphene::chain
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/pending_transaction_pool.hpp>
+
+#include <fc/uint128.hpp>
+
+#include <queue>
+
+namespace graphene { namespace chain {
+
+int64_t pending_transaction_pool::fee_density( share_type core_fee, uint32_t size )
+{
+   if( core_fee <= 0 )
+      return 0;
+   return ( fc::uint128( core_fee.value ) * 1024 / std::max<uint32_t>( size, 1 ) ).to_uint64();
+}
+
+bool pending_transaction_pool::can_admit( int64_t fee_density, uint32_t size )
+{
+   uint64_t count_needed = _entries.size() + 1 > _max_size ? _entries.size() + 1 - _max_size : 0;
+   uint64_t bytes_needed = _bytes + size > _max_bytes ? _bytes + size - _max_bytes : 0;
+   if( count_needed == 0 && bytes_needed == 0 )
+      return true;
+
+   if( size <= _max_bytes && _max_size > 0 )
+   {
+      const auto& by_value = _entries.get<by_fee_density>();
+      for( auto itr = by_value.begin(); itr != by_value.end() && itr->fee_density < fee_density; ++itr )
+      {
+         count_needed -= std::min<uint64_t>( count_needed, 1 );
+         bytes_needed -= std::min<uint64_t>( bytes_needed, itr->size );
+         if( count_needed == 0 && bytes_needed == 0 )
+            return true;
+      }
+   }
+   ++_stats.refused;
+   return false;
+}
+
+bool pending_transaction_pool::within_fee_payer_quota( account_id_type fee_payer, uint32_t size )
+{
+   if( ( _max_size_per_fee_payer == 0 && _max_bytes_per_fee_payer == 0 )
+       || _quota_exempt_fee_payers.find( fee_payer ) != _quota_exempt_fee_payers.end() )
+      return true;
+
+   uint32_t count = 0;
+   uint64_t bytes = size;
+   auto usage = _fee_payer_usage.find( fee_payer );
+   if( usage != _fee_payer_usage.end() )
+   {
+      count = usage->second.count;
+      bytes += usage->second.bytes;
+   }
+   if( ( _max_size_per_fee_payer == 0 || count < _max_size_per_fee_payer )
+       && ( _max_bytes_per_fee_payer == 0 || bytes <= _max_bytes_per_fee_payer ) )
+      return true;
+   ++_stats.over_quota;
+   return false;
+}
+
+vector<transaction_id_type> pending_transaction_pool::add( const sealed_transaction& trx, account_id_type fee_payer,
+                                                           share_type core_fee,
+                                                           std::shared_ptr<const vector<object_id_type>> accessed_objects )
+{
+   entry e;
+   e.trx = trx;
+   e.fee_payer = fee_payer;
+   e.core_fee = core_fee;
+   e.size = trx.packed_size();
+   e.fee_density = fee_density( core_fee, e.size );
+   e.accessed_objects = std::move( accessed_objects );
+   if( !insert( std::move(e) ) )
+      return vector<transaction_id_type>();
+   ++_stats.added;
+   return evict();
+}
+
+vector<transaction_id_type> pending_transaction_pool::carry_over( entry e )
+{
+   if( !insert( std::move(e) ) )
+      return vector<transaction_id_type>();
+   ++_stats.carried_over;
+   return evict();
+}
+
+bool pending_transaction_pool::insert( entry&& e )
+{
+   e.sequence = _next_sequence++;
+   if( !_entries.push_back( std::move(e) ).second )
+      return false;
+   const entry& added = _entries.back();
+   _bytes += added.size;
+   fee_payer_usage& usage = _fee_payer_usage[added.fee_payer];
+   ++usage.count;
+   usage.bytes += added.size;
+   return true;
+}
+
+void pending_transaction_pool::forget( const entry& e )
+{
+   _bytes -= e.size;
+   auto usage = _fee_payer_usage.find( e.fee_payer );
+   if( usage == _fee_payer_usage.end() )
+      return;
+   if( --usage->second.count == 0 )
+      _fee_payer_usage.erase( usage );
+   else
+      usage->second.bytes -= e.size;
+}
+
+vector<transaction_id_type> pending_transaction_pool::evict()
+{
+   vector<transaction_id_type> evicted;
+   auto& by_value = _entries.get<by_fee_density>();
+   while( !by_value.empty() && ( _entries.size() > _max_size || _bytes > _max_bytes ) )
+   {
+      evicted.push_back( by_value.begin()->id() );
+      forget( *by_value.begin() );
+      by_value.erase( by_value.begin() );
+      ++_stats.evicted;
+   }
+   return evicted;
+}
+
+uint32_t pending_transaction_pool::remove_expired( time_point_sec now )
+{
+   auto& by_exp = _entries.get<by_expiration>();
+   uint32_t removed = 0;
+   while( !by_exp.empty() && by_exp.begin()->expiration() < now )
+   {
+      forget( *by_exp.begin() );
+      by_exp.erase( by_exp.begin() );
+      ++removed;
+   }
+   _stats.expired += removed;
+   return removed;
+}
+
+bool pending_transaction_pool::remove( const transaction_id_type& id )
+{
+   auto& by_id = _entries.get<by_trx_id>();
+   auto itr = by_id.find( id );
+   if( itr == by_id.end() )
+      return false;
+   forget( *itr );
+   by_id.erase( itr );
+   return true;
+}
+
+vector<pending_transaction_pool::entry> pending_transaction_pool::take_all()
+{
+   vector<entry> result( _entries.begin(), _entries.end() );
+   clear();
+   return result;
+}
+
+void pending_transaction_pool::clear()
+{
+   _entries.clear();
+   _bytes = 0;
+   _fee_payer_usage.clear();
+}
+
+optional<sealed_transaction> pending_transaction_pool::find( const transaction_id_type& id )const
+{
+   const auto& by_id = _entries.get<by_trx_id>();
+   auto itr = by_id.find( id );
+   if( itr == by_id.end() )
+      return optional<sealed_transaction>();
+   return itr->trx;
+}
+
+bool pending_transaction_pool::contains( const transaction_id_type& id )const
+{
+   const auto& by_id = _entries.get<by_trx_id>();
+   return by_id.find( id ) != by_id.end();
+}
+
+uint32_t pending_transaction_pool::count_by_fee_payer( account_id_type payer )const
+{
+   auto usage = _fee_payer_usage.find( payer );
+   return usage == _fee_payer_usage.end() ? 0 : usage->second.count;
+}
+
+void pending_transaction_pool::for_each_by_value( const std::function<bool(const entry&)>& visit )const
+{
+   typedef index_type::index<by_fee_payer>::type::const_iterator payer_iterator;
+   // the next entry of each fee payer, highest fee density on top, then earliest
+   auto lower_value = []( const payer_iterator& a, const payer_iterator& b )
+   {
+      if( a->fee_density != b->fee_density )
+         return a->fee_density < b->fee_density;
+      return a->sequence > b->sequence;
+   };
+   std::priority_queue< payer_iterator, vector<payer_iterator>, decltype(lower_value) > heads( lower_value );
+
+   const auto& by_payer = _entries.get<by_fee_payer>();
+   for( auto itr = by_payer.begin(); itr != by_payer.end();
+        itr = by_payer.upper_bound( boost::make_tuple( itr->fee_payer ) ) )
+      heads.push( itr );
+
+   while( !heads.empty() )
+   {
+      payer_iterator itr = heads.top();
+      heads.pop();
+      if( !visit( *itr ) )
+         continue;
+      payer_iterator next = std::next( itr );
+      if( next != by_payer.end() && next->fee_payer == itr->fee_payer )
+         heads.push( next );
+   }
+}
+
+void pending_transaction_pool::set_limits( uint32_t max_size, uint64_t max_bytes )
+{
+   _max_size = max_size;
+   _max_bytes = max_bytes;
+   evict();
+}
+
+void pending_transaction_pool::set_fee_payer_quota( uint32_t max_size, uint64_t max_bytes )
+{
+   _max_size_per_fee_payer = max_size;
+   _max_bytes_per_fee_payer = max_bytes;
+}
+
+void pending_transaction_pool::set_quota_exempt_fee_payers( flat_set<account_id_type> exempt )
+{
+   _quota_exempt_fee_payers = std::move( exempt );
+}
+
+pending_transaction_pool::stats pending_transaction_pool::get_stats()const
+{
+   stats result = _stats;
+   result.size = _entries.size();
+   result.bytes = _bytes;
+   result.max_size = _max_size;
+   result.max_bytes = _max_bytes;
+   result.max_size_per_fee_payer = _max_size_per_fee_payer;
+   result.max_bytes_per_fee_payer = _max_bytes_per_fee_payer;
+   return result;
+}
+
+} } // graphene::chain
@@ -62,16 +62,48 @@ namespace graphene { namespace chain {
       return signee() == expected_signee;
    }
 
+   namespace {
+      /// runs f serially, for trees that are too small to be worth spreading over threads
+      void for_each_serial( size_t count, const std::function<void(size_t)>& f )
+      {
+         for( size_t i = 0; i < count; ++i )
+            f(i);
+      }
+
+      /// levels with fewer pairs than this are hashed serially
+      const size_t parallel_merkle_min_pairs = 256;
+      /// pairs hashed by a single task of for_each
+      const size_t merkle_pairs_per_task = 64;
+   }
+
    checksum_type signed_block::calculate_merkle_root()const
    {
-      if( transactions.size() == 0 ) 
-         return checksum_type();
+      return calculate_merkle_root( for_each_serial );
+   }
 
+   checksum_type signed_block::calculate_merkle_root( const for_each_index_type& for_each )const
+   {
       vector<digest_type> ids;
       ids.resize( transactions.size() );
-      for( uint32_t i = 0; i < transactions.size(); ++i )
-         ids[i] = transactions[i].merkle_digest();
+      if( transactions.size() >= parallel_merkle_min_pairs )
+         for_each( ids.size(), [&]( size_t i ) { ids[i] = transactions[i].merkle_digest(); } );
+      else
+         for( uint32_t i = 0; i < transactions.size(); ++i )
+            ids[i] = transactions[i].merkle_digest();
+      return calculate_merkle_root( std::move(ids), for_each );
+   }
+
+   checksum_type signed_block::calculate_merkle_root( vector<digest_type> ids )
+   {
+      return calculate_merkle_root( std::move(ids), for_each_serial );
+   }
+
+   checksum_type signed_block::calculate_merkle_root( vector<digest_type> ids, const for_each_index_type& for_each )
+   {
+      if( ids.size() == 0 )
+         return checksum_type();
 
+      vector<digest_type> next;
       vector<digest_type>::size_type current_number_of_hashes = ids.size();
       while( current_number_of_hashes > 1 )
       {
@@ -79,8 +111,25 @@ namespace graphene { namespace chain {
          uint32_t i_max = current_number_of_hashes - (current_number_of_hashes&1);
          uint32_t k = 0;
 
-         for( uint32_t i = 0; i < i_max; i += 2 )
-            ids[k++] = digest_type::hash( std::make_pair( ids[i], ids[i+1] ) );
+         size_t pairs = i_max / 2;
+         if( pairs >= parallel_merkle_min_pairs )
+         {
+            // pair k is written to next[k] so no task overwrites a hash another task still reads
+            next.resize( pairs );
+            size_t tasks = ( pairs + merkle_pairs_per_task - 1 ) / merkle_pairs_per_task;
+            for_each( tasks, [&]( size_t t ) {
+               size_t end = std::min( pairs, (t + 1) * merkle_pairs_per_task );
+               for( size_t p = t * merkle_pairs_per_task; p < end; ++p )
+                  next[p] = digest_type::hash( std::make_pair( ids[2*p], ids[2*p+1] ) );
+            } );
+            std::copy( next.begin(), next.begin() + pairs, ids.begin() );
+            k = pairs;
+         }
+         else
+         {
+            for( uint32_t i = 0; i < i_max; i += 2 )
+               ids[k++] = digest_type::hash( std::make_pair( ids[i], ids[i+1] ) );
+         }
 
          if( current_number_of_hashes&1 )
             ids[k++] = ids[i_max];
@@ -89,4 +138,66 @@ namespace graphene { namespace chain {
       return checksum_type::hash( ids[0] );
    }
 
+   sealed_block::sealed_block( signed_block b, const chain_id_type& chain_id )
+      : sealed_block( std::move(b), chain_id, for_each_serial )
+   {
+   }
+
+   sealed_block::sealed_block( signed_block b, const chain_id_type& chain_id, const for_each_type& for_each )
+      : _block( std::make_shared<signed_block>( std::move(b) ) )
+   {
+      // each sealed transaction points into our copy of the block instead of copying the transaction
+      vector< optional<sealed_transaction> > sealed( _block->transactions.size() );
+      for_each( sealed.size(), [&]( size_t i ) {
+         sealed[i] = sealed_transaction( shared_ptr<const processed_transaction>( _block, &_block->transactions[i] ), chain_id );
+      } );
+      _transactions.reserve( sealed.size() );
+      for( auto& t : sealed )
+         _transactions.push_back( std::move(*t) );
+      seal_header();
+   }
+
+   sealed_block::sealed_block( signed_block b, vector<sealed_transaction> transactions )
+      : _block( std::make_shared<signed_block>( std::move(b) ) ), _transactions( std::move(transactions) )
+   {
+      FC_ASSERT( _transactions.size() == _block->transactions.size() );
+      seal_header();
+   }
+
+   void sealed_block::seal_header()
+   {
+      const signed_block& b = *_block;
+      vector<char> header = fc::raw::pack( static_cast<const block_header&>( b ) );
+      _digest = digest_type::hash( header.data(), header.size() );
+
+      vector<char> signature = fc::raw::pack( b.witness_signature );
+      header.insert( header.end(), signature.begin(), signature.end() );
+      auto tmp = fc::sha224::hash( header.data(), header.size() );
+      tmp._hash[0] = fc::endian_reverse_u32(b.block_num()); // same as signed_block_header::id()
+      memcpy(_id._hash, tmp._hash, std::min(sizeof(_id), sizeof(tmp)));
+
+      _packed_size = header.size() + fc::raw::pack_size( fc::unsigned_int( _transactions.size() ) );
+      for( const auto& t : _transactions )
+         _packed_size += t.packed_size();
+   }
+
+   checksum_type sealed_block::calculate_merkle_root()const
+   {
+      return calculate_merkle_root( for_each_serial );
+   }
+
+   checksum_type sealed_block::calculate_merkle_root( const for_each_type& for_each )const
+   {
+      vector<digest_type> ids;
+      ids.reserve( _transactions.size() );
+      for( const auto& t : _transactions )
+         ids.push_back( t.merkle_digest() );
+      return signed_block::calculate_merkle_root( std::move(ids), for_each );
+   }
+
+   fc::ecc::public_key sealed_block::signee()const
+   {
+      return fc::ecc::public_key( _block->witness_signature, _digest, true/*enforce canonical*/ );
+   }
+
 } }
@@ -122,21 +122,52 @@ namespace graphene { namespace chain {
       this->scale = 0;
    }
 
-   asset fee_schedule::calculate_fee( const operation& op, const price& core_exchange_rate )const
+   void fee_schedule::build_lookup_table()const
    {
-      //idump( (op)(core_exchange_rate) );
-      fee_parameters params; params.set_which(op.which());
+      auto table = std::make_shared< vector<fee_parameters> >( fee_parameters::count() );
+      for( int i = 0; i < fee_parameters::count(); ++i )
+         (*table)[i].set_which(i);
+      for( const auto& p : parameters )
+         (*table)[p.which()] = p;
+      _lookup_table = std::move(table);
+   }
+
+   const fee_parameters* fee_schedule::find_parameters( int tag )const
+   {
+      if( _lookup_table )
+         return &(*_lookup_table)[tag];
+      fee_parameters params; params.set_which(tag);
       auto itr = parameters.find(params);
-      if( itr != parameters.end() ) params = *itr;
-      auto base_value = op.visit( calc_fee_visitor( params ) );
+      if( itr != parameters.end() )
+         return &*itr;
+      return nullptr;
+   }
+
+   share_type fee_schedule::scale_fee( uint64_t base_value )const
+   {
       auto scaled = fc::uint128(base_value) * scale;
       scaled /= GRAPHENE_100_PERCENT;
       FC_ASSERT( scaled <= GRAPHENE_MAX_SHARE_SUPPLY );
+      return scaled.to_uint64();
+   }
+
+   asset fee_schedule::calculate_fee( const operation& op, const price& core_exchange_rate )const
+   {
+      //idump( (op)(core_exchange_rate) );
+      const fee_parameters* found = find_parameters( op.which() );
+      fee_parameters defaults;
+      if( found == nullptr )
+      {
+         defaults.set_which(op.which());
+         found = &defaults;
+      }
+      auto base_value = op.visit( calc_fee_visitor( *found ) );
+      share_type scaled = scale_fee( base_value );
       //idump( (base_value)(scaled)(core_exchange_rate) );
-      auto result = asset( scaled.to_uint64(), asset_id_type(0) ) * core_exchange_rate;
+      auto result = asset( scaled, asset_id_type(0) ) * core_exchange_rate;
       //FC_ASSERT( result * core_exchange_rate >= asset( scaled.to_uint64()) );
 
-      while( result * core_exchange_rate < asset( scaled.to_uint64()) )
+      while( result * core_exchange_rate < asset( scaled ) )
         result.amount++;
 
       FC_ASSERT( result.amount <= GRAPHENE_MAX_SHARE_SUPPLY );
@@ -71,11 +71,35 @@ struct operation_get_required_auth
    }
 };
 
+struct operation_get_fee_visitor
+{
+   typedef asset result_type;
+   template<typename T>
+   asset operator()( const T& v )const { return v.fee; }
+};
+
+struct operation_get_fee_payer_visitor
+{
+   typedef account_id_type result_type;
+   template<typename T>
+   account_id_type operator()( const T& v )const { return v.fee_payer(); }
+};
+
 void operation_validate( const operation& op )
 {
    op.visit( operation_validator() );
 }
 
+asset operation_get_fee( const operation& op )
+{
+   return op.visit( operation_get_fee_visitor() );
+}
+
+account_id_type operation_get_fee_payer( const operation& op )
+{
+   return op.visit( operation_get_fee_payer_visitor() );
+}
+
 void operation_get_required_authorities( const operation& op, 
                                          flat_set<account_id_type>& active,
                                          flat_set<account_id_type>& owner,
@@ -27,6 +27,7 @@
 #include <fc/bitutil.hpp>
 #include <fc/smart_ref_impl.hpp>
 #include <algorithm>
+#include <limits>
 
 namespace graphene { namespace chain {
 
@@ -294,12 +295,11 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
       tx_irrelevant_sig,
       "Unnecessary signature(s) detected"
       );
-} FC_CAPTURE_AND_RETHROW( (ops)(sigs) ) }
+} GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW( (ops)(sigs) ) }
 
 
-flat_set<public_key_type> signed_transaction::get_signature_keys( const chain_id_type& chain_id )const
-{ try {
-   auto d = sig_digest( chain_id );
+static flat_set<public_key_type> recover_signature_keys( const vector<signature_type>& signatures, const digest_type& d )
+{
    flat_set<public_key_type> result;
    for( const auto&  sig : signatures )
    {
@@ -309,6 +309,11 @@ flat_set<public_key_type> signed_transaction::get_signature_keys( const chain_id
          "Duplicate Signature detected" );
    }
    return result;
+}
+
+flat_set<public_key_type> signed_transaction::get_signature_keys( const chain_id_type& chain_id )const
+{ try {
+   return recover_signature_keys( signatures, sig_digest( chain_id ) );
 } FC_CAPTURE_AND_RETHROW() }
 
 
@@ -347,6 +352,204 @@ set<public_key_type> signed_transaction::get_required_signatures(
    return result;
 }
 
+/**
+ *  Non-throwing counterpart of verify_authority() used while searching for a
+ *  minimal key set.  Evaluates the same sign_state rules in the same order, so
+ *  a key set accepted here is accepted by verify_authority() as well.
+ */
+static bool is_authorized_by( const flat_set<account_id_type>& required_active,
+                              const flat_set<account_id_type>& required_owner,
+                              const vector<authority>& other,
+                              const flat_set<public_key_type>& keys,
+                              const std::function<const authority*(account_id_type)>& get_active,
+                              const std::function<const authority*(account_id_type)>& get_owner,
+                              uint32_t max_recursion )
+{
+   sign_state s( keys, get_active );
+   s.max_recursion = max_recursion;
+
+   for( const auto& auth : other )
+      if( !s.check_authority( &auth ) )
+         return false;
+   for( auto id : required_active )
+      if( !s.check_authority( id ) && !s.check_authority( get_owner( id ) ) )
+         return false;
+   for( auto id : required_owner )
+      if( !s.check_authority( get_owner( id ) ) )
+         return false;
+   return true;
+}
+
+/**
+ *  The authorities a transaction needs, as weights collected from a set of
+ *  candidate keys.  Every authority remembers its current weight and whether
+ *  it meets its threshold, so dropping a key only walks the authorities that
+ *  depend on it instead of re-running verify_authority().
+ *
+ *  This follows sign_state exactly as long as no address authority is
+ *  involved and every account is reached at a single depth.  Otherwise the
+ *  result of sign_state depends on the order it approves accounts in, and
+ *  exact() returns false.
+ */
+class authority_weights
+{
+   public:
+      authority_weights( const flat_set<public_key_type>& c,
+                         const std::function<const authority*(account_id_type)>& a,
+                         const std::function<const authority*(account_id_type)>& o,
+                         uint32_t r )
+      : candidates(c), get_active(a), get_owner(o), max_recursion(r) {}
+
+      void require( const authority* au )
+      {
+         requirements.emplace_back( add_node( au, 0 ), size_t( npos ) );
+      }
+
+      /** Like sign_state, accepts either the active or the owner authority */
+      void require_active( account_id_type id )
+      {
+         if( id == GRAPHENE_TEMP_ACCOUNT )
+            return;
+         size_t active = account_node( id, 0 );
+         requirements.emplace_back( active, add_node( get_owner( id ), 0 ) );
+      }
+
+      bool exact()const { return _exact; }
+
+      bool satisfied()const
+      {
+         for( const auto& r : requirements )
+            if( !nodes[r.first].satisfied && ( r.second == npos || !nodes[r.second].satisfied ) )
+               return false;
+         return true;
+      }
+
+      /** Drops @ref k if every requirement is still satisfied without it */
+      bool try_remove( const public_key_type& k )
+      {
+         auto uses = key_uses.find( k );
+         if( uses == key_uses.end() )
+            return true;
+
+         vector< std::pair<size_t,uint64_t> > previous_weights;
+         vector<size_t> unsatisfied;
+         vector< std::pair<size_t,uint64_t> > pending( uses->second.begin(), uses->second.end() );
+         while( !pending.empty() )
+         {
+            auto p = pending.back();
+            pending.pop_back();
+            node& n = nodes[p.first];
+            previous_weights.emplace_back( p.first, n.weight );
+            n.weight -= p.second;
+            if( n.satisfied && n.weight < n.threshold )
+            {
+               n.satisfied = false;
+               unsatisfied.push_back( p.first );
+               pending.insert( pending.end(), n.parents.begin(), n.parents.end() );
+            }
+         }
+         if( satisfied() )
+            return true;
+
+         for( auto itr = previous_weights.rbegin(); itr != previous_weights.rend(); ++itr )
+            nodes[itr->first].weight = itr->second;
+         for( size_t i : unsatisfied )
+            nodes[i].satisfied = true;
+         return false;
+      }
+
+   private:
+      struct node
+      {
+         uint64_t                               threshold = std::numeric_limits<uint64_t>::max();
+         uint64_t                               weight = 0;
+         bool                                   satisfied = false;
+         vector< std::pair<size_t,uint64_t> >   parents;
+      };
+
+      static const size_t npos = size_t(-1);
+
+      void note_depth( account_id_type id, uint32_t depth )
+      {
+         auto itr = account_depth.find( id );
+         if( itr == account_depth.end() )
+            account_depth[id] = depth;
+         else if( itr->second != depth )
+            _exact = false;
+      }
+
+      size_t account_node( account_id_type id, uint32_t depth )
+      {
+         note_depth( id, depth );
+         auto itr = account_nodes.find( id );
+         if( itr != account_nodes.end() )
+            return itr->second;
+         size_t index = add_node( get_active( id ), depth );
+         account_nodes[id] = index;
+         return index;
+      }
+
+      size_t add_node( const authority* au, uint32_t depth )
+      {
+         size_t index = nodes.size();
+         nodes.emplace_back();
+         if( au == nullptr )
+            return index;
+         const authority& auth = *au;
+         if( !auth.address_auths.empty() )
+            _exact = false;
+
+         uint64_t weight = 0;
+         for( const auto& k : auth.key_auths )
+            if( candidates.find( k.first ) != candidates.end() )
+            {
+               key_uses[k.first].emplace_back( index, k.second );
+               weight += k.second;
+            }
+
+         // at the recursion limit sign_state gives up on the first account it
+         // has not approved yet, so only a leading temp account still counts
+         bool at_limit = false;
+         for( const auto& a : auth.account_auths )
+         {
+            if( a.first == GRAPHENE_TEMP_ACCOUNT )
+            {
+               if( !at_limit )
+                  weight += a.second;
+               continue;
+            }
+            if( depth == max_recursion )
+            {
+               note_depth( a.first, depth + 1 );
+               at_limit = true;
+               continue;
+            }
+            size_t child = account_node( a.first, depth + 1 );
+            nodes[child].parents.emplace_back( index, a.second );
+            if( nodes[child].satisfied )
+               weight += a.second;
+         }
+
+         node& n = nodes[index];
+         n.threshold = auth.weight_threshold;
+         n.weight = weight;
+         n.satisfied = weight >= n.threshold;
+         return index;
+      }
+
+      const flat_set<public_key_type>&                          candidates;
+      const std::function<const authority*(account_id_type)>&   get_active;
+      const std::function<const authority*(account_id_type)>&   get_owner;
+      uint32_t                                                  max_recursion;
+      bool                                                      _exact = true;
+
+      vector<node>                                              nodes;
+      vector< std::pair<size_t,size_t> >                        requirements;
+      flat_map<account_id_type,size_t>                          account_nodes;
+      flat_map<account_id_type,uint32_t>                        account_depth;
+      flat_map< public_key_type, vector< std::pair<size_t,uint64_t> > > key_uses;
+};
+
 set<public_key_type> signed_transaction::minimize_required_signatures(
    const chain_id_type& chain_id,
    const flat_set<public_key_type>& available_keys,
@@ -356,20 +559,46 @@ set<public_key_type> signed_transaction::minimize_required_signatures(
    ) const
 {
    set< public_key_type > s = get_required_signatures( chain_id, available_keys, get_active, get_owner, max_recursion );
-   flat_set< public_key_type > result( s.begin(), s.end() );
+   if( s.empty() )
+      return s;
+
+   flat_set<account_id_type> required_active;
+   flat_set<account_id_type> required_owner;
+   vector<authority> other;
+   get_required_authorities( required_active, required_owner, other );
+
+   GRAPHENE_ASSERT( required_active.find(GRAPHENE_COMMITTEE_ACCOUNT) == required_active.end(),
+                    invalid_committee_approval, "Committee account may only propose transactions" );
+
+   const flat_set< public_key_type > candidates( s.begin(), s.end() );
+   flat_set< public_key_type > result = candidates;
+
+   // Drop keys in order, keeping each one only if some authority falls below
+   // its threshold without it.  This gives the same keys as dropping each one
+   // and calling verify_authority() again, without the repeated full checks.
+   authority_weights weights( candidates, get_active, get_owner, max_recursion );
+   for( const auto& auth : other )
+      weights.require( &auth );
+   for( auto id : required_active )
+      weights.require_active( id );
+   for( auto id : required_owner )
+      weights.require( get_owner( id ) );
+
+   if( weights.exact() )
+   {
+      if( !weights.satisfied() )
+         return s;
+      for( const public_key_type& k : s )
+         if( weights.try_remove( k ) )
+            result.erase( k );
+      return set<public_key_type>( result.begin(), result.end() );
+   }
 
    for( const public_key_type& k : s )
    {
       result.erase( k );
-      try
-      {
-         graphene::chain::verify_authority( operations, result, get_active, get_owner, max_recursion );
-         continue;  // element stays erased if verify_authority is ok
-      }
-      catch( const tx_missing_owner_auth& e ) {}
-      catch( const tx_missing_active_auth& e ) {}
-      catch( const tx_missing_other_auth& e ) {}
-      result.insert( k );
+      if( !is_authorized_by( required_active, required_owner, other, result, get_active, get_owner, max_recursion ) )
+         result.insert( k );
    }
    return set<public_key_type>( result.begin(), result.end() );
 }
@@ -383,4 +612,45 @@ void signed_transaction::verify_authority(
    graphene::chain::verify_authority( operations, get_signature_keys( chain_id ), get_active, get_owner, max_recursion );
 } FC_CAPTURE_AND_RETHROW( (*this) ) }
 
+sealed_transaction::sealed_transaction( processed_transaction trx, const chain_id_type& chain_id )
+   : _trx( std::make_shared<processed_transaction>( std::move(trx) ) )
+{
+   seal( chain_id );
+}
+
+sealed_transaction::sealed_transaction( shared_ptr<const processed_transaction> trx, const chain_id_type& chain_id )
+   : _trx( std::move(trx) )
+{
+   seal( chain_id );
+}
+
+void sealed_transaction::seal( const chain_id_type& chain_id )
+{
+   auto data = std::make_shared<sealed_data>();
+   vector<char>& packed = data->packed;
+   auto append = [&packed]( const vector<char>& v ) { packed.insert( packed.end(), v.begin(), v.end() ); };
+
+   packed = fc::raw::pack( static_cast<const transaction&>( *_trx ) );
+   size_t trx_size = packed.size();
+   append( fc::raw::pack( _trx->signatures ) );
+   data->signed_size = packed.size();
+   append( fc::raw::pack( _trx->operation_results ) );
+
+   data->digest = digest_type::hash( packed.data(), trx_size );
+   memcpy( data->id._hash, data->digest._hash, std::min( sizeof(data->id), sizeof(data->digest) ) );
+
+   digest_type::encoder enc;
+   fc::raw::pack( enc, chain_id );
+   enc.write( packed.data(), trx_size );
+   data->sig_digest = enc.result();
+
+   data->merkle_digest = digest_type::hash( packed.data(), packed.size() );
+   _data = std::move( data );
+}
+
+flat_set<public_key_type> sealed_transaction::get_signature_keys()const
+{ try {
+   return recover_signature_keys( _trx->signatures, _data->sig_digest );
+} FC_CAPTURE_AND_RETHROW() }
+
 } } // graphene::chain
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/recent_transaction_cache.hpp>
+
+namespace graphene { namespace chain {
+
+optional<signed_transaction> recent_transaction_cache::find( const transaction_id_type& id )const
+{
+   const auto& idx = _entries.get<by_trx_id>();
+   auto itr = idx.find( id );
+   if( itr == idx.end() )
+   {
+      ++_stats.misses;
+      return optional<signed_transaction>();
+   }
+   ++_stats.hits;
+   return itr->trx;
+}
+
+void recent_transaction_cache::insert( const sealed_transaction& trx )
+{
+   if( _max_size == 0 )
+      return;
+
+   auto& idx = _entries.get<by_trx_id>();
+   auto itr = idx.find( trx.id() );
+   if( itr != idx.end() )
+   {
+      // seen again, e.g. when a block applies a transaction which was pending; keep it longer
+      _entries.relocate( _entries.end(), _entries.project<0>( itr ) );
+      return;
+   }
+   // copy the transaction out, the sealed one may share a whole block
+   _entries.push_back( entry{ trx.id(), signed_transaction( trx.get() ) } );
+   evict();
+}
+
+void recent_transaction_cache::evict()
+{
+   while( _entries.size() > _max_size )
+      _entries.pop_front();
+}
+
+void recent_transaction_cache::set_max_size( uint32_t max_size )
+{
+   _max_size = max_size;
+   evict();
+}
+
+void recent_transaction_cache::clear()
+{
+   _entries.clear();
+}
+
+recent_transaction_cache::stats recent_transaction_cache::get_stats()const
+{
+   stats result = _stats;
+   result.size = _entries.size();
+   result.max_size = _max_size;
+   return result;
+}
+
+} } // graphene::chain
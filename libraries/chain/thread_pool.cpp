@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/thread_pool.hpp>
+
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace graphene { namespace chain {
+
+thread_pool::thread_pool( uint32_t thread_count )
+{
+   _threads.reserve( thread_count );
+   for( uint32_t i = 0; i < thread_count; ++i )
+      _threads.emplace_back( [this](){ worker_loop(); } );
+}
+
+thread_pool::~thread_pool()
+{
+   {
+      std::unique_lock<std::mutex> lock( _mutex );
+      _stopping = true;
+   }
+   _condition.notify_all();
+   for( auto& t : _threads )
+      t.join();
+}
+
+void thread_pool::worker_loop()
+{
+   while( true )
+   {
+      std::function<void()> task;
+      {
+         std::unique_lock<std::mutex> lock( _mutex );
+         _condition.wait( lock, [this](){ return _stopping || !_tasks.empty(); } );
+         if( _tasks.empty() )
+            return;
+         task = std::move( _tasks.front() );
+         _tasks.pop_front();
+      }
+      task();
+   }
+}
+
+namespace detail {
+   /// State shared by the calling thread and the helpers of one parallel_for() call
+   struct parallel_for_state
+   {
+      parallel_for_state( size_t c, const std::function<void(size_t)>& fn ) : count(c), f(fn) {}
+
+      void drain()
+      {
+         for( size_t i = next++; i < count; i = next++ )
+         {
+            try {
+               f(i);
+            } catch( ... ) {
+               std::unique_lock<std::mutex> lock( mutex );
+               if( !error )
+                  error = std::current_exception();
+            }
+         }
+      }
+
+      const size_t                       count;
+      const std::function<void(size_t)>& f;
+      std::atomic<size_t>                next{0};
+      std::mutex                         mutex;
+      std::condition_variable            done;
+      size_t                             running_helpers = 0;
+      std::exception_ptr                 error;
+   };
+}
+
+void thread_pool::parallel_for( size_t count, const std::function<void(size_t)>& f )
+{
+   if( count == 0 )
+      return;
+
+   if( _threads.empty() || count == 1 )
+   {
+      for( size_t i = 0; i < count; ++i )
+         f(i);
+      return;
+   }
+
+   auto state = std::make_shared<detail::parallel_for_state>( count, f );
+   size_t helpers = std::min<size_t>( _threads.size(), count - 1 );
+   state->running_helpers = helpers;
+   {
+      std::unique_lock<std::mutex> lock( _mutex );
+      for( size_t i = 0; i < helpers; ++i )
+         _tasks.emplace_back( [state]()
+         {
+            state->drain();
+            std::unique_lock<std::mutex> lock( state->mutex );
+            if( --state->running_helpers == 0 )
+               state->done.notify_one();
+         } );
+   }
+   _condition.notify_all();
+
+   state->drain();
+
+   // f lives on our stack, so every helper must be finished with it before we return
+   std::unique_lock<std::mutex> lock( state->mutex );
+   state->done.wait( lock, [&state](){ return state->running_helpers == 0; } );
+   if( state->error )
+      std::rethrow_exception( state->error );
+}
+
+} } // graphene::chain
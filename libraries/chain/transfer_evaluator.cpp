@@ -65,14 +65,15 @@ void_result transfer_evaluator::do_evaluate( const transfer_operation& op )
       }
 
       bool insufficient_balance = d.get_balance( from_account, asset_type ).amount >= op.amount.amount;
-      FC_ASSERT( insufficient_balance,
-                 "Insufficient Balance: ${balance}, unable to transfer '${total_transfer}' from account '${a}' to '${t}'", 
-                 ("a",from_account.name)("t",to_account.name)("total_transfer",d.to_pretty_string(op.amount))("balance",d.to_pretty_string(d.get_balance(from_account, asset_type))) );
+      GRAPHENE_ASSERT( insufficient_balance, insufficient_funds,
+                       "Insufficient Balance: ${balance}, unable to transfer '${total_transfer}' from account '${a}' to '${t}'", 
+                       ("a",from_account.name)("t",to_account.name)("total_transfer",op.amount)("balance",d.get_balance(from_account, asset_type)) );
 
       return void_result();
-   } FC_RETHROW_EXCEPTIONS( error, "Unable to transfer ${a} from ${f} to ${t}", ("a",d.to_pretty_string(op.amount))("f",op.from(d).name)("t",op.to(d).name) );
+   } GRAPHENE_RETHROW_TRANSACTION_REJECTIONS
+     FC_RETHROW_EXCEPTIONS( error, "Unable to transfer ${a} from ${f} to ${t}", ("a",d.to_pretty_string(op.amount))("f",op.from(d).name)("t",op.to(d).name) );
 
-}  FC_CAPTURE_AND_RETHROW( (op) ) }
+}  GRAPHENE_RETHROW_TRANSACTION_REJECTIONS FC_CAPTURE_AND_RETHROW( (op) ) }
 
 void_result transfer_evaluator::do_apply( const transfer_operation& o )
 { try {
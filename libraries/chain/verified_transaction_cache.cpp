@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/chain/verified_transaction_cache.hpp>
+
+namespace graphene { namespace chain {
+
+optional< flat_set<public_key_type> > verified_transaction_cache::find( const digest_type& sig_digest,
+                                                                        const vector<signature_type>& signatures )const
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   const auto& idx = _entries.get<by_digest>();
+   auto itr = idx.find( sig_digest );
+   // the signature digest does not cover the signatures, so a copy of the transaction
+   // carrying different signatures must be treated as a different transaction
+   if( itr == idx.end() || itr->signatures != signatures )
+   {
+      ++_stats.misses;
+      return optional< flat_set<public_key_type> >();
+   }
+   ++_stats.hits;
+   return itr->signature_keys;
+}
+
+void verified_transaction_cache::insert( const digest_type& sig_digest, const vector<signature_type>& signatures,
+                                         const flat_set<public_key_type>& signature_keys )
+{
+   if( _max_size == 0 )
+      return;
+
+   std::unique_lock<std::mutex> lock( _mutex );
+   auto& idx = _entries.get<by_digest>();
+   auto itr = idx.find( sig_digest );
+   if( itr != idx.end() )
+   {
+      idx.modify( itr, [&]( entry& e ) {
+         e.signatures = signatures;
+         e.signature_keys = signature_keys;
+      });
+      return;
+   }
+   _entries.push_back( entry{ sig_digest, signatures, signature_keys } );
+   evict();
+}
+
+void verified_transaction_cache::evict()
+{
+   while( _entries.size() > _max_size )
+   {
+      _entries.pop_front();
+      ++_stats.evictions;
+   }
+}
+
+void verified_transaction_cache::set_max_size( uint32_t max_size )
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   _max_size = max_size;
+   evict();
+}
+
+void verified_transaction_cache::clear()
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   _entries.clear();
+}
+
+verified_transaction_cache::stats verified_transaction_cache::get_stats()const
+{
+   std::unique_lock<std::mutex> lock( _mutex );
+   stats result = _stats;
+   result.size = _entries.size();
+   result.max_size = _max_size;
+   return result;
+}
+
+} } // graphene::chain
@@ -267,6 +267,15 @@ namespace graphene { namespace db {
          }
 
 
+         /** used by undo to restore removed objects, which the secondary indexes must see again */
+         virtual const object&  insert( object&& obj )override
+         {
+            const auto& result = DerivedIndex::insert( std::move(obj) );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            return result;
+         }
+
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
             const auto& result = DerivedIndex::create( constructor );
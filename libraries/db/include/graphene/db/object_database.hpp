@@ -32,6 +32,19 @@
 
 namespace graphene { namespace db {
 
+   /**
+    *  @brief ids of the objects read and written while an access tracker is installed
+    *
+    *  Reads are recorded by get_object() and find_object(), so objects that are only reached
+    *  through a secondary index of an index type are not recorded unless the lookup calls
+    *  note_read().  Writes cover every create, modify and remove.
+    */
+   struct object_access_set
+   {
+      flat_set<object_id_type> reads;
+      flat_set<object_id_type> writes;
+   };
+
    /**
     *   @class object_database
     *   @brief maintains a set of indexed objects that can be modified with multi-level rollback support
@@ -141,6 +154,21 @@ namespace graphene { namespace db {
 
          void pop_undo();
 
+         /**
+          *  Records the ids of the objects the calling thread accesses from now on in tracker, until
+          *  it is set to nullptr.  Each thread has its own tracker, so worker threads that only read
+          *  can record their reads while another thread is tracked.  The tracker must outlive the
+          *  time it is installed.
+          */
+         void set_access_tracker( object_access_set* tracker );
+         /// @return the tracker the calling thread installed on this database, if any
+         object_access_set* get_access_tracker()const;
+         /// Records a read of an object found without get_object() or find_object()
+         void note_read( object_id_type id )const;
+
+         /// Calls inspector for every index of the database
+         void inspect_all_indexes( const std::function<void(const index&)>& inspector )const;
+
          fc::path get_data_dir()const { return _data_dir; }
 
          /** public for testing purposes only... should be private in practice. */
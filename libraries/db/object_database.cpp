@@ -42,15 +42,48 @@ void object_database::close()
 {
 }
 
+namespace {
+   /// the tracker installed by the current thread and the database it was installed on
+   thread_local const object_database* tracked_database = nullptr;
+   thread_local object_access_set*     thread_access_tracker = nullptr;
+}
+
+void object_database::set_access_tracker( object_access_set* tracker )
+{
+   tracked_database = tracker ? this : nullptr;
+   thread_access_tracker = tracker;
+}
+
+object_access_set* object_database::get_access_tracker()const
+{
+   return tracked_database == this ? thread_access_tracker : nullptr;
+}
+
+void object_database::note_read( object_id_type id )const
+{
+   if( object_access_set* tracker = get_access_tracker() )
+      tracker->reads.insert( id );
+}
+
 const object* object_database::find_object( object_id_type id )const
 {
+   note_read( id );
    return get_index(id.space(),id.type()).find( id );
 }
 const object& object_database::get_object( object_id_type id )const
 {
+   note_read( id );
    return get_index(id.space(),id.type()).get( id );
 }
 
+void object_database::inspect_all_indexes( const std::function<void(const index&)>& inspector )const
+{
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx )
+            inspector( *idx );
+}
+
 const index& object_database::get_index(uint8_t space_id, uint8_t type_id)const
 {
    FC_ASSERT( _index.size() > space_id, "", ("space_id",space_id)("type_id",type_id)("index.size",_index.size()) );
@@ -109,16 +142,22 @@ void object_database::pop_undo()
 
 void object_database::save_undo( const object& obj )
 {
+   if( object_access_set* tracker = get_access_tracker() )
+      tracker->writes.insert( obj.id );
    _undo_db.on_modify( obj );
 }
 
 void object_database::save_undo_add( const object& obj )
 {
+   if( object_access_set* tracker = get_access_tracker() )
+      tracker->writes.insert( obj.id );
    _undo_db.on_create( obj );
 }
 
 void object_database::save_undo_remove(const object& obj)
 {
+   if( object_access_set* tracker = get_access_tracker() )
+      tracker->writes.insert( obj.id );
    _undo_db.on_remove( obj );
 }
 
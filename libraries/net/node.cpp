@@ -472,6 +472,8 @@ namespace graphene { namespace net { namespace detail {
       unsigned _items_to_fetch_sequence_counter;
       items_to_fetch_set_type _items_to_fetch; /// list of items we know another peer has and we want
       peer_connection::timestamped_items_set_type _recently_failed_items; /// list of transactions we've recently pushed and had rejected by the delegate
+      fc::time_point _last_rejection_logged; /// when a message rejected by the delegate was last logged
+      uint32_t _rejections_not_logged; /// messages rejected by the delegate since then that were only counted
       // @}
 
       /// used by the task that advertises inventory during normal operation
@@ -803,6 +805,7 @@ namespace graphene { namespace net { namespace detail {
       _suspend_fetching_sync_blocks(false),
       _items_to_fetch_updated(false),
       _items_to_fetch_sequence_counter(0),
+      _rejections_not_logged(0),
       _recent_block_interval_in_seconds(GRAPHENE_MAX_BLOCK_INTERVAL),
       _user_agent_string(user_agent),
       _desired_number_of_connections(GRAPHENE_NET_DEFAULT_DESIRED_CONNECTIONS),
@@ -3822,7 +3825,19 @@ namespace graphene { namespace net { namespace detail {
         }
         catch ( const fc::exception& e )
         {
-          wlog( "client rejected message sent by peer ${peer}, ${e}", ("peer", originating_peer->get_remote_endpoint() )("e", e) );
+          // a flood of invalid transactions would otherwise spend more time logging the
+          // rejections than rejecting them, so log one per second and count the rest
+          fc::time_point now = fc::time_point::now();
+          if( now - _last_rejection_logged > fc::seconds(1) )
+          {
+            if( _rejections_not_logged > 0 )
+              wlog( "client rejected ${n} more messages that were not logged", ("n", _rejections_not_logged) );
+            wlog( "client rejected message sent by peer ${peer}, ${e}", ("peer", originating_peer->get_remote_endpoint() )("e", e) );
+            _last_rejection_logged = now;
+            _rejections_not_logged = 0;
+          }
+          else
+            ++_rejections_not_logged;
           // record it so we don't try to fetch this item again
           _recently_failed_items.insert(peer_connection::timestamped_item_id(item_id(message_to_process.msg_type, message_hash ), fc::time_point::now()));
           return;
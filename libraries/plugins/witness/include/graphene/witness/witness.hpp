@@ -28,6 +28,8 @@
 
 #include <fc/thread/future.hpp>
 
+#include <deque>
+
 namespace graphene { namespace witness_plugin {
 
 namespace block_production_condition
@@ -42,10 +44,63 @@ namespace block_production_condition
       low_participation = 5,
       lag = 6,
       consecutive = 7,
-      exception_producing_block = 8
+      exception_producing_block = 8,
+      preassembled = 9
    };
 }
 
+/**
+ *  @brief latencies in power of two buckets of microseconds, bucket i counting samples in
+ *  [2^i, 2^(i+1)) us
+ */
+struct latency_histogram
+{
+   uint64_t                 count    = 0;
+   int64_t                  total_us = 0;
+   int64_t                  max_us   = 0;
+   std::vector<uint64_t>    buckets;
+
+   void record( int64_t us );
+};
+
+/// where the time to produce one block went, in microseconds
+struct produced_block_timings
+{
+   uint32_t            block_num = 0;
+   fc::time_point_sec  timestamp;
+   /// the database's breakdown of generate_block()
+   chain::block_generation_timings  generation;
+   /// handing the block to the p2p node
+   int64_t             broadcast_us = 0;
+   /// from the slot time to the block being ready to broadcast
+   int64_t             latency_us = 0;
+};
+
+/**
+ *  @brief what the witness plugin spent producing blocks, and why slots of its witnesses were
+ *  missed
+ */
+struct block_production_stats
+{
+   uint64_t                                  produced = 0;
+   /// slots of our witnesses that were not produced, by block_production_condition
+   fc::flat_map<std::string, uint64_t>       missed;
+
+   /// prepare_block_candidate() ahead of the slot
+   latency_histogram                         preassemble;
+   latency_histogram                         assemble;
+   latency_histogram                         sign;
+   latency_histogram                         apply;
+   latency_histogram                         restore_pending;
+   /// the whole generate_block() call
+   latency_histogram                         generate;
+   latency_histogram                         broadcast;
+   latency_histogram                         latency;
+
+   /// the most recently produced blocks, oldest first
+   std::vector<produced_block_timings>       recent_blocks;
+};
+
 class witness_plugin : public graphene::app::plugin {
 public:
    ~witness_plugin() {
@@ -72,16 +127,38 @@ public:
    virtual void plugin_startup() override;
    virtual void plugin_shutdown() override;
 
+   block_production_stats get_block_production_stats()const;
+   void reset_block_production_stats();
+
 private:
    void schedule_production_loop();
    block_production_condition::block_production_condition_enum block_production_loop();
    block_production_condition::block_production_condition_enum maybe_produce_block( fc::mutable_variant_object& capture );
+   void record_production( block_production_condition::block_production_condition_enum result );
+   void record_broadcast( uint32_t block_num, fc::microseconds elapsed );
+   void log_production_summary();
 
    boost::program_options::variables_map _options;
    bool _production_enabled = false;
    bool _consecutive_production_enabled = false;
    uint32_t _required_witness_participation = 33 * GRAPHENE_1_PERCENT;
    uint32_t _production_skip_flags = graphene::chain::database::skip_nothing;
+   /// how long before our slot the block is assembled, zero to assemble it at the slot
+   fc::microseconds _preassembly_lead = fc::milliseconds( 250 );
+   /// the slot of the block candidate prepared by the database
+   fc::time_point_sec _preassembled_slot;
+
+   /// how many of the last produced blocks to keep the timings of
+   static const size_t recent_block_count = 100;
+   block_production_stats _production_stats;
+   std::deque<produced_block_timings> _recent_blocks;
+   /// the slot of one of our witnesses considered by the current wakeup, if any
+   fc::time_point_sec _scheduled_slot;
+   /// the last slot counted as missed, so a slot is counted once
+   fc::time_point_sec _last_missed_slot;
+   /// time between production summaries in the log, zero to disable them
+   fc::microseconds _summary_interval;
+   fc::time_point _last_summary;
 
    std::map<chain::public_key_type, fc::ecc::private_key> _private_keys;
    std::set<chain::witness_id_type> _witnesses;
@@ -89,3 +166,13 @@ private:
 };
 
 } } //graphene::witness_plugin
+
+FC_REFLECT_ENUM( graphene::witness_plugin::block_production_condition::block_production_condition_enum,
+                 (produced)(not_synced)(not_my_turn)(not_time_yet)(no_private_key)(low_participation)
+                 (lag)(consecutive)(exception_producing_block)(preassembled) )
+FC_REFLECT( graphene::witness_plugin::latency_histogram, (count)(total_us)(max_us)(buckets) )
+FC_REFLECT( graphene::witness_plugin::produced_block_timings,
+            (block_num)(timestamp)(generation)(broadcast_us)(latency_us) )
+FC_REFLECT( graphene::witness_plugin::block_production_stats,
+            (produced)(missed)(preassemble)(assemble)(sign)(apply)(restore_pending)(generate)
+            (broadcast)(latency)(recent_blocks) )
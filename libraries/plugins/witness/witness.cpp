@@ -32,6 +32,7 @@
 #include <fc/smart_ref_impl.hpp>
 #include <fc/thread/thread.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace graphene::witness_plugin;
@@ -75,6 +76,10 @@ void witness_plugin::plugin_set_program_options(
          ("private-key", bpo::value<vector<string>>()->composing()->multitoken()->
           DEFAULT_VALUE_VECTOR(std::make_pair(chain::public_key_type(default_priv_key.get_public_key()), graphene::utilities::key_to_wif(default_priv_key))),
           "Tuple of [PublicKey, WIF private key] (may specify multiple times)")
+         ("block-preassembly-ms", bpo::value<uint32_t>()->default_value(250),
+          "Milliseconds ahead of its slot to start assembling a block, at most 450, 0 to assemble it at the slot")
+         ("production-summary-minutes", bpo::value<uint32_t>()->default_value(0),
+          "Minutes between summaries of block production timings in the log, 0 to disable them")
          ;
    config_file_options.add(command_line_options);
 }
@@ -89,6 +94,10 @@ void witness_plugin::plugin_initialize(const boost::program_options::variables_m
    ilog("witness plugin:  plugin_initialize() begin");
    _options = &options;
    LOAD_VALUE_SET(options, "witness-id", _witnesses, chain::witness_id_type)
+   if( options.count("block-preassembly-ms") )
+      _preassembly_lead = fc::milliseconds( std::min<uint32_t>( options["block-preassembly-ms"].as<uint32_t>(), 450 ) );
+   if( options.count("production-summary-minutes") )
+      _summary_interval = fc::minutes( options["production-summary-minutes"].as<uint32_t>() );
 
    if( options.count("private-key") )
    {
@@ -146,6 +155,79 @@ void witness_plugin::plugin_shutdown()
    return;
 }
 
+void latency_histogram::record( int64_t us )
+{
+   us = std::max<int64_t>( us, 0 );
+   ++count;
+   total_us += us;
+   max_us = std::max( max_us, us );
+   size_t bucket = 0;
+   for( int64_t v = us; v > 1; v >>= 1 )
+      ++bucket;
+   if( buckets.size() <= bucket )
+      buckets.resize( bucket + 1 );
+   ++buckets[bucket];
+}
+
+block_production_stats witness_plugin::get_block_production_stats()const
+{
+   block_production_stats result = _production_stats;
+   result.recent_blocks.assign( _recent_blocks.begin(), _recent_blocks.end() );
+   return result;
+}
+
+void witness_plugin::reset_block_production_stats()
+{
+   _production_stats = block_production_stats();
+   _recent_blocks.clear();
+}
+
+void witness_plugin::record_production( block_production_condition::block_production_condition_enum result )
+{
+   switch( result )
+   {
+      case block_production_condition::no_private_key:
+      case block_production_condition::low_participation:
+      case block_production_condition::lag:
+      case block_production_condition::consecutive:
+      case block_production_condition::exception_producing_block:
+         break;
+      default:
+         return;
+   }
+   // Several wakeups can consider the same slot, and failing ahead of the slot does not miss it yet
+   if( _scheduled_slot == fc::time_point_sec() || _scheduled_slot <= _last_missed_slot
+       || graphene::time::now() < fc::time_point( _scheduled_slot ) )
+      return;
+   _last_missed_slot = _scheduled_slot;
+   ++_production_stats.missed[ fc::reflector<block_production_condition::block_production_condition_enum>::to_string( result ) ];
+}
+
+void witness_plugin::record_broadcast( uint32_t block_num, fc::microseconds elapsed )
+{
+   _production_stats.broadcast.record( elapsed.count() );
+   for( auto itr = _recent_blocks.rbegin(); itr != _recent_blocks.rend(); ++itr )
+   {
+      if( itr->block_num == block_num )
+      {
+         itr->broadcast_us = elapsed.count();
+         break;
+      }
+   }
+}
+
+void witness_plugin::log_production_summary()
+{
+   const block_production_stats& s = _production_stats;
+   auto mean = []( const latency_histogram& h ) { return h.count ? h.total_us / int64_t(h.count) : 0; };
+   ilog( "Produced ${n} blocks, missed ${m}. Mean / max us: generate ${g} / ${gx}, assemble ${a} / ${ax}, "
+         "apply ${p} / ${px}, restore pending ${r} / ${rx}, broadcast ${b} / ${bx}, latency ${l} / ${lx}",
+         ("n", s.produced)("m", s.missed)
+         ("g", mean(s.generate))("gx", s.generate.max_us)("a", mean(s.assemble))("ax", s.assemble.max_us)
+         ("p", mean(s.apply))("px", s.apply.max_us)("r", mean(s.restore_pending))("rx", s.restore_pending.max_us)
+         ("b", mean(s.broadcast))("bx", s.broadcast.max_us)("l", mean(s.latency))("lx", s.latency.max_us) );
+}
+
 void witness_plugin::schedule_production_loop()
 {
    //Schedule for the next second's tick regardless of chain state
@@ -156,7 +238,24 @@ void witness_plugin::schedule_production_loop()
    if( time_to_next_second < 50000 )      // we must sleep for at least 50ms
        time_to_next_second += 1000000;
 
-   fc::time_point next_wakeup( fc_now + fc::microseconds( time_to_next_second ) );
+   fc::microseconds wait( time_to_next_second );
+
+   // When the next slot is ours, wake up ahead of it to assemble the block, then exactly at it
+   chain::database& db = database();
+   if( _witnesses.find( db.get_scheduled_witness( 1 ) ) != _witnesses.end() )
+   {
+      fc::time_point slot_time = db.get_slot_time( 1 );
+      for( fc::time_point target : { slot_time - _preassembly_lead, slot_time } )
+      {
+         if( target > ntp_now )
+         {
+            wait = std::min( wait, target - ntp_now );
+            break;
+         }
+      }
+   }
+
+   fc::time_point next_wakeup( fc_now + wait );
 
    //wdump( (now.time_since_epoch().count())(next_wakeup.time_since_epoch().count()) );
    _block_production_task = fc::schedule([this]{block_production_loop();},
@@ -185,7 +284,10 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
    switch( result )
    {
       case block_production_condition::produced:
-         ilog("Generated block #${n} with timestamp ${t} at time ${c}", (capture));
+         ilog("Generated block #${n} with timestamp ${t} at time ${c}, ${l} us after its slot", (capture));
+         break;
+      case block_production_condition::preassembled:
+         ilog("Assembled ${n} transactions for the block at ${t}", (capture));
          break;
       case block_production_condition::not_synced:
          ilog("Not producing block because production is disabled until we receive a recent block (see: --enable-stale-production)");
@@ -211,6 +313,19 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
       case block_production_condition::exception_producing_block:
          break;
    }
+   record_production( result );
+
+   if( _summary_interval.count() > 0 )
+   {
+      fc::time_point now = fc::time_point::now();
+      if( _last_summary == fc::time_point() )
+         _last_summary = now;
+      else if( now - _last_summary >= _summary_interval )
+      {
+         log_production_summary();
+         _last_summary = now;
+      }
+   }
 
    schedule_production_loop();
    return result;
@@ -221,6 +336,7 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
    chain::database& db = database();
    fc::time_point now_fine = graphene::time::now();
    fc::time_point_sec now = now_fine + fc::microseconds( 500000 );
+   _scheduled_slot = fc::time_point_sec();
 
    // If the next block production opportunity is in the present or future, we're synced.
    if( !_production_enabled )
@@ -258,6 +374,7 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
    }
 
    fc::time_point_sec scheduled_time = db.get_slot_time( slot );
+   _scheduled_slot = scheduled_time;
    graphene::chain::public_key_type scheduled_key = scheduled_witness( db ).signing_key;
    auto private_key_itr = _private_keys.find( scheduled_key );
 
@@ -280,14 +397,53 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
       return block_production_condition::lag;
    }
 
+   // Woken up ahead of the slot: assemble the block now, and only add its header and
+   // signature at the slot
+   if( now_fine < fc::time_point( scheduled_time ) )
+   {
+      if( _preassembly_lead.count() == 0 || _preassembled_slot == scheduled_time )
+      {
+         capture("next_time", scheduled_time);
+         return block_production_condition::not_time_yet;
+      }
+      _preassembled_slot = scheduled_time;
+      fc::time_point start = fc::time_point::now();
+      capture("n", db.prepare_block_candidate( _production_skip_flags ))("t", scheduled_time);
+      _production_stats.preassemble.record( (fc::time_point::now() - start).count() );
+      return block_production_condition::preassembled;
+   }
+
    auto block = db.generate_block(
       scheduled_time,
       scheduled_witness,
       private_key_itr->second,
       _production_skip_flags
       );
-   capture("n", block.block_num())("t", block.timestamp)("c", now);
-   fc::async( [this,block](){ p2p_node().broadcast(net::block_message(block)); } );
+   fc::microseconds latency = graphene::time::now() - fc::time_point( scheduled_time );
+   capture("n", block.block_num())("t", block.timestamp)("c", now)("l", latency.count());
+
+   produced_block_timings timings;
+   timings.block_num = block.block_num();
+   timings.timestamp = block.timestamp;
+   timings.generation = db.get_last_generation_timings();
+   timings.latency_us = latency.count();
+   ++_production_stats.produced;
+   if( !timings.generation.preassembled )
+      _production_stats.assemble.record( timings.generation.assemble_us );
+   _production_stats.sign.record( timings.generation.sign_us );
+   _production_stats.apply.record( timings.generation.apply_us );
+   _production_stats.restore_pending.record( timings.generation.restore_pending_us );
+   _production_stats.generate.record( timings.generation.total_us );
+   _production_stats.latency.record( timings.latency_us );
+   _recent_blocks.push_back( timings );
+   if( _recent_blocks.size() > recent_block_count )
+      _recent_blocks.pop_front();
+
+   fc::async( [this,block](){
+      fc::time_point start = fc::time_point::now();
+      p2p_node().broadcast(net::block_message(block));
+      record_broadcast( block.block_num(), fc::time_point::now() - start );
+   } );
 
    return block_production_condition::produced;
 }
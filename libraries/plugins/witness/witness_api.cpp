@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/witness/witness_api.hpp>
+
+#include <graphene/app/application.hpp>
+
+namespace graphene { namespace witness_plugin {
+
+witness_api::witness_api( graphene::app::application& app ) : _app( app )
+{}
+
+std::shared_ptr< witness_plugin > witness_api::get_plugin()const
+{
+   return _app.get_plugin< witness_plugin >( "witness" );
+}
+
+block_production_stats witness_api::get_block_production_stats()const
+{
+   return get_plugin()->get_block_production_stats();
+}
+
+void witness_api::reset_block_production_stats()
+{
+   get_plugin()->reset_block_production_stats();
+}
+
+} } // graphene::witness_plugin
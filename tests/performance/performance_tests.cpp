@@ -23,12 +23,18 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/database_api.hpp>
+
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/protocol/protocol.hpp>
 
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/market_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
+#include <graphene/chain/thread_pool.hpp>
+#include <graphene/chain/transaction_object.hpp>
 
 #include <graphene/db/simple_index.hpp>
 
@@ -50,8 +56,871 @@ BOOST_AUTO_TEST_CASE( sigcheck_benchmark )
    auto end = fc::time_point::now();
    auto elapsed = end-start;
    wdump( ((100000.0*1000000.0) / elapsed.count()) );
+
+   thread_pool pool( std::max( std::thread::hardware_concurrency(), 1u ) - 1 );
+   start = fc::time_point::now();
+   pool.parallel_for( 100000, [&]( size_t ) { auto pub = fc::ecc::public_key( sig, digest ); } );
+   end = fc::time_point::now();
+   elapsed = end-start;
+   ilog( "Recovered ${n} signatures per second on ${t} threads", ("n", (100000.0*1000000.0) / elapsed.count())("t", pool.thread_count() + 1) );
+}
+
+BOOST_FIXTURE_TEST_CASE( block_signature_precompute_benchmark, database_fixture )
+{
+   const uint32_t trx_count = 1000;
+   fc::ecc::private_key sender_key = generate_private_key( "sender" );
+   signed_block b;
+   for( uint32_t i = 0; i < trx_count; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = account_id_type( 1 );
+      op.to = account_id_type( 2 );
+      op.amount = asset( i + 1 );
+      tx.operations.push_back( op );
+      tx.set_expiration( db.head_block_time() + fc::minutes(1) );
+      tx.sign( sender_key, db.get_chain_id() );
+      b.transactions.push_back( tx );
+   }
+   b.sign( init_account_priv_key );
+
+   auto start = fc::time_point::now();
+   for( const auto& tx : b.transactions )
+      tx.get_signature_keys( db.get_chain_id() );
+   auto serial = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   precomputed_block_checks checks = db.precompute_block_checks( db.seal_block( b ), database::skip_nothing );
+   auto parallel = fc::time_point::now() - start;
+
+   BOOST_REQUIRE_EQUAL( checks.transactions.size(), trx_count );
+   for( const auto& c : checks.transactions )
+      BOOST_CHECK( c.signature_keys.valid() && *c.signature_keys->begin() == public_key_type( sender_key.get_public_key() ) );
+   BOOST_CHECK( checks.signee.valid() && *checks.signee == public_key_type( init_account_priv_key.get_public_key() ) );
+
+   ilog( "Recovered keys of ${n} transactions: serial ${s} us, pre-pass on ${t} threads ${p} us",
+         ("n", trx_count)("s", serial.count())("t", db.get_thread_pool().thread_count() + 1)("p", parallel.count()) );
+}
+
+BOOST_FIXTURE_TEST_CASE( block_stateless_validation_benchmark, database_fixture )
+{
+   for( uint32_t trx_count : { 1000u, 10000u, 50000u } )
+   {
+      signed_block b;
+      for( uint32_t i = 0; i < trx_count; ++i )
+      {
+         signed_transaction tx;
+         for( uint32_t j = 0; j < 10; ++j )
+         {
+            transfer_operation op;
+            op.from = account_id_type( 1 );
+            op.to = account_id_type( 2 );
+            op.amount = asset( i * 10 + j + 1 );
+            tx.operations.push_back( op );
+         }
+         tx.set_expiration( db.head_block_time() + fc::minutes(1) );
+         b.transactions.push_back( tx );
+      }
+      sealed_block sealed = db.seal_block( b );
+
+      auto start = fc::time_point::now();
+      for( const auto& tx : b.transactions )
+         tx.validate();
+      auto serial = fc::time_point::now() - start;
+
+      start = fc::time_point::now();
+      precomputed_block_checks checks = db.precompute_block_checks( sealed, ~0 );
+      auto parallel = fc::time_point::now() - start;
+
+      for( const auto& c : checks.transactions )
+         BOOST_CHECK( c.validated );
+      ilog( "Validated ${n} transactions: serial ${s} us, pre-pass on ${t} threads ${p} us",
+            ("n", trx_count)("s", serial.count())("t", db.get_thread_pool().thread_count() + 1)("p", parallel.count()) );
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( transaction_dedupe_store_benchmark, database_fixture )
+{
+   ACTORS( (alice)(bob) );
+   fund( alice, asset( 100000000 ) );
+
+   const uint32_t trx_count = 5000;
+   vector<signed_transaction> txs;
+   for( uint32_t i = 0; i < trx_count; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( i + 1 );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, alice_private_key );
+      txs.push_back( tx );
+   }
+
+   auto start = fc::time_point::now();
+   for( const auto& tx : txs )
+      PUSH_TX( db, tx, database::skip_transaction_signatures | database::skip_authority_check );
+   auto push_time = fc::time_point::now() - start;
+
+   // what the index holds now, and what it held when transaction_object kept the transaction
+   uint64_t object_bytes = 0;
+   uint64_t transaction_bytes = 0;
+   const auto& idx = db.get_index_type<transaction_index>().indices();
+   for( const auto& obj : idx )
+      object_bytes += fc::raw::pack_size( obj );
+   for( const auto& tx : txs )
+      transaction_bytes += fc::raw::pack_size( tx );
+
+   start = fc::time_point::now();
+   for( const auto& tx : txs )
+      db.get_recent_transaction( tx.id() );
+   auto cached_time = fc::time_point::now() - start;
+
+   generate_block( ~uint32_t( database::skip_transaction_dupe_check ) );
+   db.get_recent_transaction_cache().set_max_size( 0 );
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < trx_count; i += 50 )
+      BOOST_CHECK( db.get_recent_transaction( txs[i].id() ).id() == txs[i].id() );
+   auto block_time = fc::time_point::now() - start;
+
+   ilog( "Pushed ${n} transactions in ${p} us; dedupe objects ${o} bytes packed, ${s} bytes each in memory, "
+         "the transactions themselves ${t} bytes packed",
+         ("n", trx_count)("p", push_time.count())("o", object_bytes)("s", sizeof(transaction_object))("t", transaction_bytes) );
+   ilog( "Looked up ${n} recent transactions from the cache in ${c} us, ${m} from their block in ${b} us",
+         ("n", trx_count)("c", cached_time.count())("m", trx_count / 50)("b", block_time.count()) );
 }
+
+BOOST_FIXTURE_TEST_CASE( balance_lookup_benchmark, database_fixture )
+{
+   const uint32_t account_count = 200;
+   vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      const account_object& a = create_account( "bench" + fc::to_string(i) );
+      fund( a, asset( 1000000 ) );
+      accounts.push_back( a.id );
+   }
+   generate_block();
+
+   // transfer-heavy workload: every account pays the next one
+   const uint32_t trx_count = 20000;
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < trx_count; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = accounts[ i % account_count ];
+      op.to = accounts[ (i + 1) % account_count ];
+      op.amount = asset( 1 + i / account_count );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      PUSH_TX( db, tx, ~0 );
+   }
+   auto push_time = fc::time_point::now() - start;
+
+   const auto& balances = db.get_index_type<account_balance_index>().indices();
+   const auto& ordered = balances.get<by_account_asset>();
+   const auto& hashed = balances.get<by_account_asset_hash>();
+   const uint32_t lookups = 1000000;
+   share_type ordered_total = 0;
+   share_type hashed_total = 0;
+
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < lookups; ++i )
+      ordered_total += ordered.find( boost::make_tuple( accounts[ i % account_count ], asset_id_type() ) )->balance;
+   auto ordered_time = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < lookups; ++i )
+      hashed_total += hashed.find( boost::make_tuple( accounts[ i % account_count ], asset_id_type() ) )->balance;
+   auto hashed_time = fc::time_point::now() - start;
+
+   BOOST_CHECK( ordered_total == hashed_total );
+   ilog( "Pushed ${n} transfers in ${p} us; ${l} balance lookups among ${b} balances: ordered ${o} us, hashed ${h} us",
+         ("n", trx_count)("p", push_time.count())("l", lookups)("b", balances.size())
+         ("o", ordered_time.count())("h", hashed_time.count()) );
+}
+
+BOOST_FIXTURE_TEST_CASE( change_notification_benchmark, database_fixture )
+{
+   const uint32_t account_count = 100;
+   vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      const account_object& a = create_account( "notify" + fc::to_string(i) );
+      fund( a, asset( 1000000 ) );
+      accounts.push_back( a.id );
+   }
+   generate_block();
+
+   const uint32_t blocks = 20;
+   const uint32_t trx_per_block = 500;
+   uint32_t seq = 0;
+   auto run = [&]() {
+      auto start = fc::time_point::now();
+      for( uint32_t b = 0; b < blocks; ++b )
+      {
+         for( uint32_t i = 0; i < trx_per_block; ++i, ++seq )
+         {
+            signed_transaction tx;
+            transfer_operation op;
+            op.from = accounts[ seq % account_count ];
+            op.to = accounts[ (seq + 1) % account_count ];
+            op.amount = asset( 1 + seq / account_count );
+            tx.operations.push_back( op );
+            set_expiration( db, tx );
+            PUSH_TX( db, tx, ~0 );
+         }
+         generate_block();
+      }
+      return fc::time_point::now() - start;
+   };
+
+   // a node with no API load: nothing is connected to the change signals
+   auto idle_time = run();
+
+   // many subscribers, each receiving every pushed transaction and block
+   const uint32_t subscriber_count = 100;
+   uint64_t delivered = 0;
+   {
+      vector<boost::signals2::scoped_connection> connections;
+      for( uint32_t i = 0; i < subscriber_count; ++i )
+         connections.emplace_back( db.changed_objects.connect( [&]( const vector<object_id_type>& ids ) {
+            for( const auto& id : ids )
+               delivered += ( db.find_object( id ) != nullptr );
+         } ) );
+      auto per_notification_time = run();
+
+      ilog( "No subscribers: ${i} us; ${s} per-notification subscribers: ${p} us for ${n} transfers",
+            ("i", idle_time.count())("s", subscriber_count)("p", per_notification_time.count())
+            ("n", blocks * trx_per_block) );
+   }
+
+   // the same subscribers opting in to one coalesced snapshot per block
+   {
+      vector<boost::signals2::scoped_connection> connections;
+      for( uint32_t i = 0; i < subscriber_count; ++i )
+         connections.emplace_back( db.changed_objects_by_block.connect(
+            [&]( const std::shared_ptr<const vector<object_id_type>>& ids ) {
+               for( const auto& id : *ids )
+                  delivered += ( db.find_object( id ) != nullptr );
+            } ) );
+      auto per_block_time = run();
+
+      ilog( "${s} per-block subscribers: ${p} us for ${n} transfers",
+            ("s", subscriber_count)("p", per_block_time.count())("n", blocks * trx_per_block) );
+   }
+   BOOST_CHECK( delivered > 0 );
+}
+
+BOOST_FIXTURE_TEST_CASE( rejection_flood_benchmark, database_fixture )
+{
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   // a flood of invalid transfers cycling through the common rejection reasons
+   const uint32_t trx_count = 20000;
+   vector<signed_transaction> flood;
+   flood.reserve( trx_count );
+   for( uint32_t i = 0; i < trx_count; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = ( i % 4 == 3 ) ? bob_id : alice_id;
+      op.to = ( i % 4 == 3 ) ? alice_id : bob_id;
+      op.amount = asset( ( i % 4 == 3 ) ? 1000000000 : 1 + i );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      switch( i % 4 )
+      {
+         case 0: // expired
+            tx.expiration = db.head_block_time() - 1;
+            sign( tx, alice_private_key );
+            break;
+         case 1: // missing signature
+            break;
+         case 2: // signed by the wrong key
+            sign( tx, bob_private_key );
+            break;
+         case 3: // insufficient balance
+            sign( tx, bob_private_key );
+            break;
+      }
+      flood.push_back( tx );
+   }
+
+   uint32_t rejected = 0;
+   auto start = fc::time_point::now();
+   for( const auto& tx : flood )
+   {
+      try
+      {
+         db.push_transaction( tx );
+      }
+      catch( const fc::exception& )
+      {
+         ++rejected;
+      }
+   }
+   auto elapsed = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( rejected, trx_count );
+   ilog( "Rejected ${n} invalid transactions in ${t} us (${r} per second)",
+         ("n", trx_count)("t", elapsed.count())
+         ("r", uint64_t( trx_count ) * 1000000 / std::max<int64_t>( elapsed.count(), 1 )) );
+}
+
+BOOST_FIXTURE_TEST_CASE( pending_pool_flood_benchmark, database_fixture )
+{
+   const uint32_t account_count = 200;
+   vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      const account_object& a = create_account( "flood" + fc::to_string(i) );
+      fund( a, asset( 100000000 ) );
+      accounts.push_back( a.id );
+   }
+   generate_block();
+
+   // a pool sized for a normal load, flooded with ten times as many transactions
+   const uint32_t normal_load = 2000;
+   const uint32_t flood = normal_load * 10;
+   auto& pool = db.get_pending_transaction_pool();
+   pool.set_limits( normal_load, 64 * 1024 * 1024 );
+
+   uint32_t refused = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < flood; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = accounts[ i % account_count ];
+      op.to = accounts[ (i + 1) % account_count ];
+      op.amount = asset( 1 + i / account_count );
+      op.fee = asset( ( i * 7919 ) % 1000 );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      try
+      {
+         PUSH_TX( db, tx, ~0 );
+      }
+      catch( const pending_pool_full& )
+      {
+         ++refused;
+      }
+   }
+   auto push_time = fc::time_point::now() - start;
+   auto pool_stats = pool.get_stats();
+
+   start = fc::time_point::now();
+   generate_block();
+   auto block_time = fc::time_point::now() - start;
+
+   BOOST_CHECK_LE( pool_stats.size, normal_load );
+   BOOST_CHECK_EQUAL( pool_stats.refused, refused );
+   ilog( "Pushed ${n} transactions in ${p} us: ${s} pending in ${b} bytes, ${e} evicted, ${r} refused; "
+         "block with ${t} transactions generated in ${g} us",
+         ("n", flood)("p", push_time.count())("s", pool_stats.size)("b", pool_stats.bytes)
+         ("e", pool_stats.evicted)("r", refused)
+         ("t", db.fetch_block_by_number( db.head_block_num() )->transactions.size())("g", block_time.count()) );
+}
+
+BOOST_FIXTURE_TEST_CASE( order_book_benchmark, database_fixture )
+{
+   const account_object& seller = create_account( "seller" );
+   asset_id_type test_id = create_user_issued_asset( "TEST" ).id;
+   const uint32_t order_count = 50000;
+   const uint32_t level_count = 500;
+
+   // resting orders on both sides, created directly as matching them is not measured here
+   for( uint32_t i = 0; i < order_count; ++i )
+   {
+      db.create<limit_order_object>( [&]( limit_order_object& o ) {
+         o.seller = seller.id;
+         o.expiration = fc::time_point_sec::maximum();
+         o.for_sale = 1000 + i % 997;
+         if( i % 2 )
+            o.sell_price = asset( 1000, test_id ) / asset( 2000 + i % level_count );
+         else
+            o.sell_price = asset( 1000 ) / asset( 2000 + i % level_count, test_id );
+         o.update_sort_keys();
+      });
+   }
+
+   // what reading the whole book took before: visiting every order by price
+   auto start = fc::time_point::now();
+   const auto& by_price_idx = db.get_index_type<limit_order_index>().indices().get<by_price>();
+   uint32_t walked_levels = 0;
+   fc::uint128 walked_total = 0;
+   for( const auto& side : { std::make_pair( test_id, asset_id_type() ), std::make_pair( asset_id_type(), test_id ) } )
+   {
+      auto itr = by_price_idx.lower_bound( price::max( side.first, side.second ) );
+      auto end = by_price_idx.upper_bound( price::min( side.first, side.second ) );
+      while( itr != end )
+      {
+         price level_price = itr->sell_price;
+         for( ; itr != end && itr->sell_price == level_price; ++itr )
+            walked_total += uint64_t( itr->amount_to_receive().amount.value );
+         ++walked_levels;
+      }
+   }
+   auto walk_time = fc::time_point::now() - start;
+
+   graphene::app::database_api db_api( db );
+   start = fc::time_point::now();
+   auto book = db_api.get_order_book( "TEST", GRAPHENE_SYMBOL, level_count );
+   auto book_time = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( book.bids.size() + book.asks.size(), walked_levels );
+   fc::uint128 book_total = 0;
+   for( const auto& level : book.bids )
+      book_total += uint64_t( level.quote_amount.value );
+   for( const auto& level : book.asks )
+      book_total += uint64_t( level.base_amount.value );
+   BOOST_CHECK( book_total == walked_total );
+   ilog( "Read ${l} price levels of ${n} orders: walking the orders ${w} us, get_order_book ${b} us",
+         ("l", walked_levels)("n", order_count)("w", walk_time.count())("b", book_time.count()) );
+}
+
+BOOST_FIXTURE_TEST_CASE( feed_margin_call_benchmark, database_fixture )
+{
+   const uint32_t asset_count = 20;
+   const uint32_t borrower_count = 100;
+   const uint32_t orders_per_asset = 200;
+
+   const account_object& feeder = create_account( "feeder" );
+   const account_object& seller = create_account( "seller" );
+   transfer( committee_account, seller.id, asset( 100000000 ) );
+   vector<account_id_type> borrowers;
+   for( uint32_t i = 0; i < borrower_count; ++i )
+   {
+      borrowers.push_back( create_account( "borrower" + fc::to_string(i) ).id );
+      transfer( committee_account, borrowers.back(), asset( 100000000 ) );
+   }
+
+   // every asset has 2:1 positions and asks which only fall in the short squeeze range once the feed drops
+   vector<asset_id_type> assets;
+   for( uint32_t a = 0; a < asset_count; ++a )
+   {
+      const asset_object& mia = create_bitasset( "BITTEST" + fc::to_string(a), feeder.id );
+      update_feed_producers( mia, {feeder.id} );
+      price_feed feed;
+      feed.settlement_price = mia.amount(100) / asset(100);
+      publish_feed( mia, feeder, feed );
+      for( uint32_t i = 0; i < borrower_count; ++i )
+         borrow( borrowers[i](db), mia.amount(1000), asset(2000 + i) );
+      borrow( seller, mia.amount(10 * orders_per_asset), asset(100 * orders_per_asset) );
+      for( uint32_t i = 0; i < orders_per_asset; ++i )
+         BOOST_REQUIRE( create_sell_order( seller, mia.amount(10), asset(20) ) != nullptr );
+      assets.push_back( mia.id );
+   }
+   generate_block();
+
+   // one transaction drops the feed of every asset, each one margin calls against all of its asks
+   set_expiration( db, trx );
+   trx.operations.clear();
+   for( asset_id_type id : assets )
+   {
+      asset_publish_feed_operation op;
+      op.publisher = feeder.id;
+      op.asset_id = id;
+      op.feed.settlement_price = id(db).amount(100) / asset(150);
+      op.feed.core_exchange_rate = op.feed.settlement_price;
+      trx.operations.push_back( op );
+   }
+   for( auto& op : trx.operations ) db.current_fee_schedule().set_fee(op);
+   trx.validate();
+   auto start = fc::time_point::now();
+   db.push_transaction( trx, ~0 );
+   auto push_time = fc::time_point::now() - start;
+   trx.operations.clear();
+
+   BOOST_CHECK( db.get_index_type<limit_order_index>().indices().empty() );
+
+   start = fc::time_point::now();
+   generate_block();
+   auto block_time = fc::time_point::now() - start;
+
+   ilog( "Feeds of ${a} assets margin calling ${o} asks each: pushing the feeds ${p} us, next block ${b} us",
+         ("a", asset_count)("o", orders_per_asset)("p", push_time.count())("b", block_time.count()) );
+}
+
+BOOST_FIXTURE_TEST_CASE( block_packing_benchmark, database_fixture )
+{
+   const uint32_t account_count = 200;
+   const uint32_t trx_count = 20000;
+   vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      const account_object& a = create_account( "pack" + fc::to_string(i) );
+      fund( a, asset( 100000000 ) );
+      accounts.push_back( a.id );
+   }
+   generate_block();
+
+   // blocks hold a fraction of the pending transactions
+   const uint32_t max_block_size = 128 * 1024;
+   db.modify( db.get_global_properties(), [&]( global_property_object& p ) {
+      p.parameters.maximum_block_size = max_block_size;
+   });
+
+   for( uint32_t i = 0; i < trx_count; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = accounts[ i % account_count ];
+      op.to = accounts[ (i + 1) % account_count ];
+      op.amount = asset( 1 + i / account_count );
+      op.fee = asset( ( i * 7919 ) % 1000 );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      PUSH_TX( db, tx, ~0 );
+   }
+
+   // what packing the transactions in arrival order would have collected
+   const auto& pool = db.get_pending_transaction_pool();
+   size_t arrival_size = fc::raw::pack_size( signed_block_header() ) + 4;
+   share_type arrival_fees = 0;
+   flat_map<transaction_id_type, share_type> fees;
+   for( const auto& entry : pool.entries() )
+   {
+      fees[ entry.id() ] = entry.core_fee;
+      if( arrival_size + entry.size < max_block_size )
+      {
+         arrival_size += entry.size;
+         arrival_fees += entry.core_fee;
+      }
+   }
+
+   auto start = fc::time_point::now();
+   generate_block();
+   auto block_time = fc::time_point::now() - start;
+
+   auto block = db.fetch_block_by_number( db.head_block_num() );
+   share_type block_fees = 0;
+   for( const auto& tx : block->transactions )
+      block_fees += fees[ tx.id() ];
+   BOOST_CHECK_GE( block_fees.value, arrival_fees.value );
+   ilog( "Built a block of ${t} out of ${n} pending transactions in ${g} us, collecting ${f} in fees "
+         "(${a} in arrival order)",
+         ("t", block->transactions.size())("n", trx_count)("g", block_time.count())
+         ("f", block_fees)("a", arrival_fees) );
+}
+
+BOOST_FIXTURE_TEST_CASE( block_preassembly_benchmark, database_fixture )
+{
+   const uint32_t account_count = 200;
+   const uint32_t trx_count = 5000;
+   vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      const account_object& a = create_account( "pre" + fc::to_string(i) );
+      fund( a, asset( 100000000 ) );
+      accounts.push_back( a.id );
+   }
+   generate_block();
+
+   auto fill_pool = [&]( uint32_t round ) {
+      for( uint32_t i = 0; i < trx_count; ++i )
+      {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = accounts[ i % account_count ];
+         op.to = accounts[ (i + 1) % account_count ];
+         op.amount = asset( 1 + i / account_count + round * trx_count );
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         PUSH_TX( db, tx, ~0 );
+      }
+   };
+
+   // assembled at the slot
+   fill_pool( 0 );
+   auto start = fc::time_point::now();
+   generate_block();
+   auto at_slot = fc::time_point::now() - start;
+
+   // assembled ahead of the slot, only sealed and signed at the slot
+   fill_pool( 1 );
+   start = fc::time_point::now();
+   uint32_t assembled = db.prepare_block_candidate( ~0 );
+   auto ahead = fc::time_point::now() - start;
+   start = fc::time_point::now();
+   generate_block();
+   auto sealed = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( assembled, db.fetch_block_by_number( db.head_block_num() )->transactions.size() );
+   ilog( "Block of ${n} transactions: ${s} us assembled at the slot, ${a} us assembled ahead and ${f} us at the slot",
+         ("n", assembled)("s", at_slot.count())("a", ahead.count())("f", sealed.count()) );
+}
+
+BOOST_FIXTURE_TEST_CASE( pending_carry_over_benchmark, database_fixture )
+{
+   const uint32_t account_count = 200;
+   const uint32_t trx_count = 5000;
+   fc::ecc::private_key key = generate_private_key( "carry" );
+   vector<account_id_type> accounts;
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      const account_object& a = create_account( "carry" + fc::to_string(i), key.get_public_key() );
+      fund( a, asset( 100000000 ) );
+      accounts.push_back( a.id );
+   }
+   generate_block();
+
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < trx_count; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = accounts[ i % account_count ];
+      op.to = accounts[ (i + 1) % account_count ];
+      op.amount = asset( 1 + i / account_count );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      tx.sign( key, db.get_chain_id() );
+      PUSH_TX( db, tx );
+   }
+   auto push_time = fc::time_point::now() - start;
+
+   // a block from another node without any of the pending transactions
+   signed_block b;
+   b.previous = db.head_block_id();
+   b.timestamp = db.get_slot_time( 1 );
+   b.witness = db.get_scheduled_witness( 1 );
+   b.transaction_merkle_root = b.calculate_merkle_root();
+   b.sign( init_account_priv_key );
+
+   start = fc::time_point::now();
+   PUSH_BLOCK( db, b );
+   auto restore_time = fc::time_point::now() - start;
+
+   auto stats = db.get_pending_transaction_pool().get_stats();
+   BOOST_CHECK_EQUAL( stats.size, trx_count );
+   ilog( "Pushed ${n} transactions in ${p} us, restored them after a block in ${r} us with ${c} carried over",
+         ("n", trx_count)("p", push_time.count())("r", restore_time.count())("c", stats.carried_over) );
+}
+
+BOOST_AUTO_TEST_CASE( call_order_sort_key_benchmark )
+{
+   // the by_collateral index as it was, computing collateralization() on every comparison
+   typedef multi_index_container<
+      call_order_object,
+      indexed_by<
+         ordered_unique< tag<by_collateral>,
+            composite_key< call_order_object,
+               const_mem_fun< call_order_object, price, &call_order_object::collateralization >,
+               member< object, object_id_type, &object::id >
+            >
+         >
+      >
+   > computed_key_index;
+   typedef multi_index_container<
+      call_order_object,
+      indexed_by<
+         ordered_unique< tag<by_collateral>,
+            composite_key< call_order_object,
+               member< call_order_object, price_sort_key, &call_order_object::collateralization_key >,
+               member< object, object_id_type, &object::id >
+            >,
+            composite_key_compare< price_sort_key_less, std::less<object_id_type> >
+         >
+      >
+   > stored_key_index;
+
+   const uint32_t call_count = 200000;
+   const asset_id_type backing = asset_id_type();
+   const asset_id_type debt_asset = asset_id_type( 1 );
+   vector<call_order_object> calls( call_count );
+   for( uint32_t i = 0; i < call_count; ++i )
+   {
+      call_order_object& c = calls[i];
+      c.id = object_id_type( call_order_object::space_id, call_order_object::type_id, i );
+      c.borrower = account_id_type( i );
+      c.collateral = 1000000 + ( uint64_t( i ) * 7919 ) % 5000000;
+      c.debt = 100000 + ( uint64_t( i ) * 104729 ) % 400000;
+      c.call_price = price::call_price( asset( c.debt, debt_asset ), asset( c.collateral, backing ), 1750 );
+      c.update_sort_keys();
+   }
+
+   computed_key_index computed;
+   stored_key_index stored;
+
+   auto start = fc::time_point::now();
+   for( const auto& c : calls )
+      computed.insert( c );
+   auto computed_insert = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( const auto& c : calls )
+      stored.insert( c );
+   auto stored_insert = fc::time_point::now() - start;
+
+   // margin position updates: every position adds collateral and is re-sorted
+   // the nodes move while being modified, so take them in their initial order first
+   vector<computed_key_index::iterator> computed_nodes;
+   for( auto itr = computed.begin(); itr != computed.end(); ++itr )
+      computed_nodes.push_back( itr );
+   vector<stored_key_index::iterator> stored_nodes;
+   for( auto itr = stored.begin(); itr != stored.end(); ++itr )
+      stored_nodes.push_back( itr );
+
+   start = fc::time_point::now();
+   for( auto itr : computed_nodes )
+      computed.modify( itr, []( call_order_object& c ) { c.collateral += 12345; } );
+   auto computed_modify = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( auto itr : stored_nodes )
+      stored.modify( itr, []( call_order_object& c ) { c.collateral += 12345; c.update_sort_keys(); } );
+   auto stored_modify = fc::time_point::now() - start;
+
+   // the least collateralized position, as check_call_orders() and settlements look it up
+   const uint32_t lookups = 1000000;
+   price least = price::min( backing, debt_asset );
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < lookups; ++i )
+      BOOST_REQUIRE( computed.lower_bound( boost::make_tuple( least ) ) != computed.end() );
+   auto computed_lookup = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < lookups; ++i )
+      BOOST_REQUIRE( stored.lower_bound( boost::make_tuple( least ) ) != stored.end() );
+   auto stored_lookup = fc::time_point::now() - start;
+
+   auto c_itr = computed.begin();
+   for( auto s_itr = stored.begin(); s_itr != stored.end(); ++s_itr, ++c_itr )
+      BOOST_REQUIRE( s_itr->id == c_itr->id );
+
+   ilog( "${n} call orders by collateral, computed / stored key: insert ${ci} / ${si} us, "
+         "modify ${cm} / ${sm} us, ${l} lookups ${cl} / ${sl} us",
+         ("n", call_count)("ci", computed_insert.count())("si", stored_insert.count())
+         ("cm", computed_modify.count())("sm", stored_modify.count())
+         ("l", lookups)("cl", computed_lookup.count())("sl", stored_lookup.count()) );
+}
+
+BOOST_AUTO_TEST_CASE( merkle_root_benchmark )
+{
+   thread_pool pool( std::max( std::thread::hardware_concurrency(), 1u ) - 1 );
+   for_each_index_type for_each = [&pool]( size_t count, const std::function<void(size_t)>& f ) { pool.parallel_for( count, f ); };
+
+   for( uint32_t num_tx : { 100u, 1000u, 10000u, 100000u } )
+   {
+      signed_block b;
+      b.transactions.resize( num_tx );
+      for( uint32_t i = 0; i < num_tx; ++i )
+         b.transactions[i].ref_block_prefix = i;
+
+      auto start = fc::time_point::now();
+      checksum_type serial_root = b.calculate_merkle_root();
+      auto serial = fc::time_point::now() - start;
+
+      start = fc::time_point::now();
+      checksum_type parallel_root = b.calculate_merkle_root( for_each );
+      auto parallel = fc::time_point::now() - start;
+
+      BOOST_CHECK( serial_root == parallel_root );
+      ilog( "Merkle root of ${n} transactions: serial ${s} us, on ${t} threads ${p} us",
+            ("n", num_tx)("s", serial.count())("t", pool.thread_count() + 1)("p", parallel.count()) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE( authority_check_cache_benchmark )
+{
+   // account 1 needs 3 of the 5 accounts 2..6, each of which needs one of two keys
+   map<account_id_type, authority> authorities;
+   vector<public_key_type> keys;
+   authority& parent = authorities[account_id_type(1)];
+   parent.weight_threshold = 3;
+   for( uint32_t i = 2; i <= 6; ++i )
+   {
+      public_key_type key = fc::ecc::private_key::regenerate( fc::sha256::hash( fc::to_string(i) ) ).get_public_key();
+      public_key_type other = fc::ecc::private_key::regenerate( fc::sha256::hash( "other" + fc::to_string(i) ) ).get_public_key();
+      keys.push_back( key );
+      authority& child = authorities[account_id_type(i)];
+      child.weight_threshold = 1;
+      child.key_auths[ other ] = 1;
+      child.key_auths[ key ] = 1;
+      parent.account_auths[ account_id_type(i) ] = 1;
+   }
+   auto get_auth = [&]( account_id_type id ) -> const authority* {
+      auto itr = authorities.find( id );
+      return itr == authorities.end() ? nullptr : &itr->second;
+   };
+   flat_set<public_key_type> sigs( keys.begin() + 2, keys.end() );
+
+   const uint32_t trx_count = 10000;
+   vector< vector<operation> > ops( trx_count );
+   for( uint32_t i = 0; i < trx_count; ++i )
+   {
+      transfer_operation op;
+      op.from = account_id_type(1);
+      op.to = account_id_type(2);
+      op.amount = asset( i + 1 );
+      ops[i].push_back( op );
+   }
+
+   auto start = fc::time_point::now();
+   for( const auto& o : ops )
+      verify_authority( o, sigs, get_auth, get_auth, GRAPHENE_MAX_SIG_CHECK_DEPTH );
+   auto uncached = fc::time_point::now() - start;
+
+   authority_check_cache cache;
+   start = fc::time_point::now();
+   for( const auto& o : ops )
+      cache.verify_authority( o, sigs, get_auth, get_auth, GRAPHENE_MAX_SIG_CHECK_DEPTH );
+   auto cached = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( cache.get_stats().misses, 1 );
+   ilog( "Checked the multisig authority of ${n} transactions: uncached ${u} us, cached ${c} us",
+         ("n", trx_count)("u", uncached.count())("c", cached.count()) );
+}
+
 /*
+BOOST_AUTO_TEST_CASE( fee_calculation_benchmark )
+{
+   vector<operation> ops( operation::count() );
+   for( int i = 0; i < operation::count(); ++i )
+      ops[i].set_which( i );
+
+   fee_schedule searched = fee_schedule::get_default();
+   fee_schedule indexed = fee_schedule::get_default();
+   indexed.build_lookup_table();
+
+   const uint32_t rounds = 20000;
+   share_type searched_total = 0;
+   share_type indexed_total = 0;
+
+   auto start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto& op : ops )
+         searched_total += searched.calculate_fee( op ).amount;
+   auto searched_time = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      for( const auto& op : ops )
+         indexed_total += indexed.calculate_fee( op ).amount;
+   auto indexed_time = fc::time_point::now() - start;
+
+   transfer_operation xfer;
+   start = fc::time_point::now();
+   share_type direct_total = 0;
+   for( uint32_t r = 0; r < rounds * ops.size(); ++r )
+      direct_total += indexed.calculate_core_fee( xfer );
+   auto direct_time = fc::time_point::now() - start;
+
+   BOOST_CHECK( searched_total == indexed_total );
+   BOOST_CHECK( direct_total == indexed.calculate_fee( xfer ).amount * int64_t( rounds * ops.size() ) );
+   uint64_t count = uint64_t( rounds ) * ops.size();
+   ilog( "Fees of ${n} operations of ${t} types: searching parameters ${s} us, lookup table ${i} us, "
+         "typed transfer fee ${d} us",
+         ("n", count)("t", ops.size())("s", searched_time.count())("i", indexed_time.count())("d", direct_time.count()) );
+}
+
 BOOST_AUTO_TEST_CASE( transfer_benchmark )
 {
    fc::ecc::private_key nathan_key = fc::ecc::private_key::generate();
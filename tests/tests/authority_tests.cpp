@@ -36,6 +36,8 @@
 #include <graphene/db/simple_index.hpp>
 
 #include <fc/crypto/digest.hpp>
+
+#include <random>
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -1313,4 +1315,251 @@ BOOST_FIXTURE_TEST_CASE( nonminimal_sig_test, database_fixture )
    }
 }
 
+/*
+ * Checks that minimize_required_signatures() returns the same keys as the
+ * previous remove-one-key-and-reverify algorithm on randomized authority
+ * graphs with weighted keys, nested accounts and recursion limits.
+ */
+BOOST_AUTO_TEST_CASE( minimize_required_signatures_randomized )
+{ try {
+   const uint32_t num_accounts = 12;
+   const uint32_t num_keys = 10;
+   const uint32_t max_depth = 2;
+
+   vector<public_key_type> keys;
+   for( uint32_t i = 0; i < num_keys; ++i )
+      keys.push_back( fc::ecc::private_key::regenerate( fc::sha256::hash( "minimize-" + fc::to_string( i ) ) ).get_public_key() );
+
+   map<account_id_type, authority> active_auths;
+   map<account_id_type, authority> owner_auths;
+   auto get_active = [&]( account_id_type id ) -> const authority* { return &active_auths[id]; };
+   auto get_owner  = [&]( account_id_type id ) -> const authority* { return &owner_auths[id]; };
+   auto account = [&]( uint32_t i ) { return account_id_type( 100 + i ); };
+
+   // the algorithm minimize_required_signatures() used before, except that
+   // a set which only has irrelevant signatures left counts as sufficient
+   // instead of letting tx_irrelevant_sig escape
+   auto reference_minimize = [&]( const signed_transaction& tx, const flat_set<public_key_type>& available )
+   {
+      set<public_key_type> s = tx.get_required_signatures( db.get_chain_id(), available, get_active, get_owner, max_depth );
+      flat_set<public_key_type> result( s.begin(), s.end() );
+      for( const public_key_type& k : s )
+      {
+         result.erase( k );
+         try
+         {
+            verify_authority( tx.operations, result, get_active, get_owner, max_depth );
+            continue;
+         }
+         catch( const tx_irrelevant_sig& e ) { continue; }
+         catch( const tx_missing_owner_auth& e ) {}
+         catch( const tx_missing_active_auth& e ) {}
+         catch( const tx_missing_other_auth& e ) {}
+         result.insert( k );
+      }
+      return set<public_key_type>( result.begin(), result.end() );
+   };
+
+   auto is_sufficient = [&]( const signed_transaction& tx, const flat_set<public_key_type>& sigs )
+   {
+      try
+      {
+         verify_authority( tx.operations, sigs, get_active, get_owner, max_depth );
+         return true;
+      }
+      catch( const tx_missing_owner_auth& e ) {}
+      catch( const tx_missing_active_auth& e ) {}
+      catch( const tx_missing_other_auth& e ) {}
+      return false;
+   };
+
+   std::mt19937 rng( 20161018 );
+   uint32_t sufficient_cases = 0;
+
+   for( uint32_t iteration = 0; iteration < 2000; ++iteration )
+   {
+      active_auths.clear();
+      owner_auths.clear();
+      for( uint32_t a = 0; a < num_accounts; ++a )
+      {
+         for( auto* auths : { &active_auths, &owner_auths } )
+         {
+            authority auth;
+            uint32_t total_weight = 0;
+            for( uint32_t n = rng() % 4; n > 0; --n )
+               auth.key_auths[ keys[ rng() % num_keys ] ] = 1 + rng() % 3;
+            for( uint32_t n = rng() % 3; n > 0; --n )
+               auth.account_auths[ account( rng() % num_accounts ) ] = 1 + rng() % 3;
+            for( const auto& k : auth.key_auths )     total_weight += k.second;
+            for( const auto& k : auth.account_auths ) total_weight += k.second;
+            auth.weight_threshold = 1 + rng() % std::max<uint32_t>( total_weight, 1 );
+            (*auths)[ account( a ) ] = auth;
+         }
+      }
+
+      signed_transaction tx;
+      for( uint32_t n = 1 + rng() % 3; n > 0; --n )
+      {
+         if( rng() % 4 )
+         {
+            transfer_operation op;
+            op.from = account( rng() % num_accounts );
+            op.to = account( rng() % num_accounts );
+            tx.operations.push_back( op );
+         }
+         else
+         {
+            account_update_operation op;
+            op.account = account( rng() % num_accounts );
+            op.owner = authority();
+            tx.operations.push_back( op );
+         }
+      }
+
+      flat_set<public_key_type> available;
+      for( const auto& k : keys )
+         if( rng() % 3 )
+            available.insert( k );
+
+      set<public_key_type> required = tx.get_required_signatures( db.get_chain_id(), available, get_active, get_owner, max_depth );
+      set<public_key_type> minimized = tx.minimize_required_signatures( db.get_chain_id(), available, get_active, get_owner, max_depth );
+      flat_set<public_key_type> minimized_set( minimized.begin(), minimized.end() );
+
+      BOOST_CHECK( std::includes( required.begin(), required.end(), minimized.begin(), minimized.end() ) );
+      BOOST_CHECK( minimized == reference_minimize( tx, available ) );
+
+      if( !is_sufficient( tx, flat_set<public_key_type>( required.begin(), required.end() ) ) )
+      {
+         // nothing can be removed from an insufficient set
+         BOOST_CHECK( minimized == required );
+         continue;
+      }
+      ++sufficient_cases;
+
+      // sufficient, free of irrelevant signatures, and no key can be dropped
+      verify_authority( tx.operations, minimized_set, get_active, get_owner, max_depth );
+      for( const auto& k : minimized )
+      {
+         flat_set<public_key_type> fewer = minimized_set;
+         fewer.erase( k );
+         BOOST_CHECK( !is_sufficient( tx, fewer ) );
+      }
+   }
+   BOOST_CHECK( sufficient_cases > 0 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( minimize_required_signatures_committee )
+{ try {
+   public_key_type committee_key = fc::ecc::private_key::regenerate( fc::sha256::hash( "minimize-committee" ) ).get_public_key();
+   authority committee_auth( 1, committee_key, 1 );
+   auto get_active = [&]( account_id_type id ) -> const authority* { return &committee_auth; };
+   auto get_owner  = [&]( account_id_type id ) -> const authority* { return &committee_auth; };
+
+   signed_transaction tx;
+   transfer_operation op;
+   op.from = GRAPHENE_COMMITTEE_ACCOUNT;
+   op.to = account_id_type( 100 );
+   tx.operations.push_back( op );
+
+   // without any usable key there is nothing to minimize
+   BOOST_CHECK( tx.minimize_required_signatures( db.get_chain_id(), flat_set<public_key_type>(), get_active, get_owner ).empty() );
+   GRAPHENE_REQUIRE_THROW( tx.minimize_required_signatures( db.get_chain_id(), { committee_key }, get_active, get_owner ),
+                           invalid_committee_approval );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( verified_transaction_cache_reuse )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+
+   transfer_operation op;
+   op.from = alice_id;
+   op.to = bob_id;
+   op.amount = asset(500);
+   trx.operations.push_back( op );
+   set_expiration( db, trx );
+   sign( trx, alice_private_key );
+
+   auto start = db.get_verified_transaction_cache().get_stats();
+   PUSH_TX( db, trx, database::skip_nothing );
+   auto pushed = db.get_verified_transaction_cache().get_stats();
+   BOOST_CHECK_EQUAL( pushed.size, start.size + 1 );
+   BOOST_CHECK_EQUAL( pushed.hits, start.hits );
+
+   // building the block and applying it reuse the keys recovered when the transaction was pushed
+   generate_block( database::skip_nothing );
+   auto applied = db.get_verified_transaction_cache().get_stats();
+   BOOST_CHECK_EQUAL( applied.size, pushed.size );
+   BOOST_CHECK( applied.hits >= pushed.hits + 2 );
+
+   // the same body with different signatures is a different transaction
+   signed_transaction tx = trx;
+   tx.signatures.clear();
+   sign( tx, bob_private_key );
+   BOOST_CHECK( !db.get_verified_transaction_cache().find( tx.sig_digest( db.get_chain_id() ), tx.signatures ).valid() );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, tx, database::skip_transaction_dupe_check ), tx_missing_active_auth );
+
+   // once alice changes her key, the cached keys no longer satisfy it and the passed authority check is dropped
+   account_update_operation uop;
+   uop.account = alice_id;
+   uop.owner = authority( 1, public_key_type( bob_private_key.get_public_key() ), 1 );
+   uop.active = authority( 1, public_key_type( bob_private_key.get_public_key() ), 1 );
+   signed_transaction utx;
+   utx.operations.push_back( uop );
+   set_expiration( db, utx );
+   sign( utx, alice_private_key );
+   PUSH_TX( db, utx, database::skip_nothing );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, trx, database::skip_transaction_dupe_check ), tx_missing_active_auth );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( authority_check_cache_reuse )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   auto push_transfer = [&]( int64_t amount, const fc::ecc::private_key& key ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset(amount);
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, key );
+      PUSH_TX( db, tx, database::skip_nothing );
+   };
+
+   auto start = db.get_authority_check_cache().get_stats();
+   push_transfer( 100, alice_private_key );
+   auto first = db.get_authority_check_cache().get_stats();
+   BOOST_CHECK_EQUAL( first.misses, start.misses + 1 );
+   BOOST_CHECK_EQUAL( first.size, start.size + 1 );
+
+   // a different transfer from the same account signed by the same key reuses the check
+   push_transfer( 200, alice_private_key );
+   auto second = db.get_authority_check_cache().get_stats();
+   BOOST_CHECK_EQUAL( second.hits, first.hits + 1 );
+   BOOST_CHECK_EQUAL( second.size, first.size );
+
+   // updating alice drops every cached check, her old key no longer passes
+   account_update_operation uop;
+   uop.account = alice_id;
+   uop.owner = authority( 1, public_key_type( bob_private_key.get_public_key() ), 1 );
+   uop.active = authority( 1, public_key_type( bob_private_key.get_public_key() ), 1 );
+   signed_transaction utx;
+   utx.operations.push_back( uop );
+   set_expiration( db, utx );
+   sign( utx, alice_private_key );
+   PUSH_TX( db, utx, database::skip_nothing );
+   BOOST_CHECK_EQUAL( db.get_authority_check_cache().get_stats().size, 0 );
+   GRAPHENE_REQUIRE_THROW( push_transfer( 300, alice_private_key ), tx_missing_active_auth );
+   push_transfer( 400, bob_private_key );
+
+   // the cache only lives for the duration of a block
+   generate_block();
+   generate_block();
+   BOOST_CHECK_EQUAL( db.get_authority_check_cache().get_stats().size, 0 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -30,6 +30,8 @@
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/exceptions.hpp>
+#include <graphene/chain/market_object.hpp>
+#include <graphene/chain/thread_pool.hpp>
 
 #include <graphene/db/simple_index.hpp>
 
@@ -178,6 +180,47 @@ BOOST_AUTO_TEST_CASE( price_test )
     BOOST_CHECK(dummy == dummy2);
 }
 
+BOOST_AUTO_TEST_CASE( price_sort_key_order )
+{
+    std::mt19937_64 rng( 1234 );
+    auto amount = [&]() { return int64_t( rng() % GRAPHENE_MAX_SHARE_SUPPLY ) + 1; };
+
+    vector<price> prices;
+    for( uint32_t i = 0; i < 100; ++i )
+    {
+       asset_id_type base( rng() % 2 );
+       asset_id_type quote( 2 + rng() % 2 );
+       int64_t b = amount();
+       int64_t q = amount();
+       prices.emplace_back( asset( b, base ), asset( q, quote ) );
+       // the same price written differently
+       if( b < GRAPHENE_MAX_SHARE_SUPPLY / 3 && q < GRAPHENE_MAX_SHARE_SUPPLY / 3 )
+          prices.emplace_back( asset( b * 3, base ), asset( q * 3, quote ) );
+       if( b > 1 && q > 1 )
+          prices.emplace_back( asset( b - 1, base ), asset( q - 1, quote ) );
+       // prices closer than the precision of the fixed point ratio
+       if( q > 2 )
+       {
+          prices.emplace_back( asset( q - 1, base ), asset( q, quote ) );
+          prices.emplace_back( asset( q - 2, base ), asset( q - 1, quote ) );
+       }
+    }
+    prices.push_back( price::max( asset_id_type(0), asset_id_type(2) ) );
+    prices.push_back( price::min( asset_id_type(0), asset_id_type(2) ) );
+
+    for( const price& a : prices )
+    {
+       price_sort_key ka( a );
+       for( const price& b : prices )
+       {
+          price_sort_key kb( b );
+          BOOST_CHECK_EQUAL( ka < kb, a < b );
+          BOOST_CHECK_EQUAL( ka < b, a < b );
+          BOOST_CHECK_EQUAL( a < kb, a < b );
+       }
+    }
+}
+
 BOOST_AUTO_TEST_CASE( memo_test )
 { try {
    memo_data m;
@@ -410,4 +453,45 @@ BOOST_AUTO_TEST_CASE( merkle_root )
    BOOST_CHECK( block.calculate_merkle_root() == c(dO) );
 }
 
+BOOST_AUTO_TEST_CASE( parallel_merkle_root )
+{
+   // the tree built level by level, as signed_block::calculate_merkle_root() did before it was parallelized
+   auto reference_root = []( vector<digest_type> ids ) -> checksum_type
+   {
+      if( ids.size() == 0 )
+         return checksum_type();
+      size_t n = ids.size();
+      while( n > 1 )
+      {
+         size_t k = 0;
+         for( size_t i = 0; i + 1 < n; i += 2 )
+            ids[k++] = digest_type::hash( std::make_pair( ids[i], ids[i+1] ) );
+         if( n & 1 )
+            ids[k++] = ids[n-1];
+         n = k;
+      }
+      return checksum_type::hash( ids[0] );
+   };
+
+   thread_pool pool( 3 );
+   for_each_index_type for_each = [&pool]( size_t count, const std::function<void(size_t)>& f ) { pool.parallel_for( count, f ); };
+
+   signed_block block;
+   vector<digest_type> leaves;
+   for( uint32_t num_tx : { 0, 1, 2, 3, 255, 511, 512, 513, 1000, 1025, 4097 } )
+   {
+      while( block.transactions.size() < num_tx )
+      {
+         block.transactions.emplace_back();
+         block.transactions.back().ref_block_prefix = block.transactions.size();
+         leaves.push_back( block.transactions.back().merkle_digest() );
+      }
+      checksum_type expected = reference_root( leaves );
+      BOOST_CHECK( block.calculate_merkle_root() == expected );
+      BOOST_CHECK( block.calculate_merkle_root( for_each ) == expected );
+      BOOST_CHECK( signed_block::calculate_merkle_root( leaves, for_each ) == expected );
+      BOOST_CHECK( sealed_block( block, db.get_chain_id(), for_each ).calculate_merkle_root( for_each ) == expected );
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -32,11 +32,15 @@
 #include <graphene/chain/committee_member_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/market_object.hpp>
+#include <graphene/chain/transaction_object.hpp>
+#include <graphene/chain/witness_object.hpp>
 
 #include <graphene/utilities/tempdir.hpp>
 
 #include <fc/crypto/digest.hpp>
 
+#include <algorithm>
+
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -180,6 +184,116 @@ BOOST_AUTO_TEST_CASE( generate_empty_blocks )
    }
 }
 
+BOOST_AUTO_TEST_CASE( pending_transactions_saved_on_close )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      auto skip_sigs = database::skip_transaction_signatures | database::skip_authority_check;
+      auto init_account_priv_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+      public_key_type init_account_pub_key = init_account_priv_key.get_public_key();
+      signed_transaction trx;
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis);
+         set_expiration( db, trx );
+         account_create_operation cop;
+         cop.name = "nathan";
+         cop.owner = authority(1, init_account_pub_key, 1);
+         cop.active = cop.owner;
+         trx.operations.push_back(cop);
+         trx.sign( init_account_priv_key, db.get_chain_id() );
+         PUSH_TX( db, trx, skip_sigs );
+         BOOST_CHECK_EQUAL( db.get_pending_transaction_pool().size(), 1u );
+         db.close();
+      }
+      {
+         database db;
+         db.open(data_dir.path(), []{return genesis_state_type();});
+         BOOST_CHECK( !fc::exists( data_dir.path() / "database" / "pending_transactions" ) );
+         BOOST_CHECK( db.get_pending_transaction_pool().empty() );
+         BOOST_CHECK_EQUAL( db.saved_pending_transactions(), 1u );
+
+         BOOST_CHECK_EQUAL( db.push_saved_pending_transactions( 10, skip_sigs ), 0u );
+         BOOST_CHECK( db.get_pending_transaction_pool().contains( trx.id() ) );
+         BOOST_CHECK( db.get_index_type<account_index>().indices().get<by_name>().count( "nathan" ) == 1 );
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( market_sort_keys_restored_on_open )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const asset_id_type other( 1 );
+      vector<price> prices = { asset( 10 ) / asset( 3, other ), asset( 10 ) / asset( 7, other ), asset( 50 ) / asset( 9, other ) };
+      {
+         database db;
+         db.open(data_dir.path(), make_genesis);
+         for( const price& p : prices )
+         {
+            db.create<limit_order_object>( [&]( limit_order_object& o ) {
+               o.seller = account_id_type();
+               o.for_sale = p.base.amount;
+               o.sell_price = p;
+               o.expiration = fc::time_point_sec::maximum();
+               o.update_sort_keys();
+            });
+            db.create<call_order_object>( [&]( call_order_object& o ) {
+               o.borrower = account_id_type();
+               o.collateral = p.base.amount;
+               o.debt = p.quote.amount;
+               o.call_price = ~p;
+               o.update_sort_keys();
+            });
+         }
+         db.close();
+      }
+      {
+         database db;
+         db.open(data_dir.path(), []{return genesis_state_type();});
+
+         // the keys are computed again and the orders are back in price order
+         const auto& limit_by_price = db.get_index_type<limit_order_index>().indices().get<by_price>();
+         BOOST_REQUIRE_EQUAL( limit_by_price.size(), prices.size() );
+         const limit_order_object* previous_limit = nullptr;
+         for( const limit_order_object& o : limit_by_price )
+         {
+            BOOST_CHECK( o.sell_price_key.exact == o.sell_price );
+            if( previous_limit )
+               BOOST_CHECK( o.sell_price < previous_limit->sell_price );
+            previous_limit = &o;
+         }
+
+         const auto& calls_by_collateral = db.get_index_type<call_order_index>().indices().get<by_collateral>();
+         BOOST_REQUIRE_EQUAL( calls_by_collateral.size(), prices.size() );
+         const call_order_object* previous_call = nullptr;
+         for( const call_order_object& o : calls_by_collateral )
+         {
+            BOOST_CHECK( o.call_price_key.exact == o.call_price );
+            BOOST_CHECK( o.collateralization_key.exact == o.collateralization() );
+            if( previous_call )
+               BOOST_CHECK( previous_call->collateralization() < o.collateralization() );
+            previous_call = &o;
+         }
+
+         // so is the price level index, one level per price
+         const auto& levels = dynamic_cast< const primary_index<limit_order_index>& >( db.get_index_type<limit_order_index>() )
+                                 .get_secondary_index<limit_order_price_level_index>();
+         auto range = levels.get_levels( asset_id_type(), other );
+         BOOST_CHECK_EQUAL( size_t( std::distance( range.first, range.second ) ), prices.size() );
+         for( auto itr = range.first; itr != range.second; ++itr )
+            BOOST_CHECK_EQUAL( itr->second.order_count, 1u );
+         db.close();
+      }
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( undo_block )
 {
    try {
@@ -549,6 +663,110 @@ BOOST_AUTO_TEST_CASE( duplicate_transactions )
    }
 }
 
+BOOST_AUTO_TEST_CASE( transaction_execution_modes_determinism )
+{
+   try {
+      fc::temp_directory dir1( graphene::utilities::temp_directory_path() ),
+                         dir2( graphene::utilities::temp_directory_path() ),
+                         dir3( graphene::utilities::temp_directory_path() ),
+                         dir4( graphene::utilities::temp_directory_path() );
+      database db1, db2, db3, db4;
+      db1.open(dir1.path(), make_genesis);
+      db2.open(dir2.path(), make_genesis);
+      db3.open(dir3.path(), make_genesis);
+      db4.open(dir4.path(), make_genesis);
+      db2.set_track_transaction_conflicts( true );
+      db4.set_worker_thread_count( 3 );
+      db4.set_speculative_execution( true );
+
+      auto skip_sigs = database::skip_transaction_signatures | database::skip_authority_check;
+      auto init_account_priv_key  = fc::ecc::private_key::regenerate(fc::sha256::hash(string("null_key")) );
+
+      auto state_digest = []( const database& db ) {
+         fc::uint128 result;
+         db.inspect_all_indexes( [&]( const graphene::db::index& idx ) { result += idx.hash(); } );
+         return result;
+      };
+      auto account = [&]( const string& name ) {
+         return db1.get_index_type<account_index>().indices().get<by_name>().find( name )->id;
+      };
+      auto make_transfer = [&]( account_id_type from, account_id_type to, int64_t amount ) {
+         transfer_operation t;
+         t.from = from;
+         t.to = to;
+         t.amount = asset( amount );
+         return t;
+      };
+      auto transfer = [&]( account_id_type from, account_id_type to, int64_t amount ) {
+         signed_transaction trx;
+         set_expiration( db1, trx );
+         trx.operations.push_back( make_transfer( from, to, amount ) );
+         PUSH_TX( db1, trx, skip_sigs );
+      };
+      // db1 generates, db2 tracks conflicts, db3 applies serially and db4 speculatively
+      auto apply_next_block = [&]() {
+         auto b = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key, skip_sigs );
+         PUSH_BLOCK( db2, b, skip_sigs );
+         PUSH_BLOCK( db3, b, skip_sigs );
+         PUSH_BLOCK( db4, b, skip_sigs );
+         BOOST_CHECK( state_digest( db2 ) == state_digest( db1 ) );
+         BOOST_CHECK( state_digest( db3 ) == state_digest( db1 ) );
+         BOOST_CHECK( state_digest( db4 ) == state_digest( db1 ) );
+         return db2.get_last_block_conflict_stats();
+      };
+
+      // every transfer is paid by the committee account, so each one conflicts with the one before
+      for( int i = 0; i < 4; ++i )
+         transfer( account_id_type(), account( "init" + fc::to_string(i) ), 10000 );
+      transaction_conflict_stats stats = apply_next_block();
+      BOOST_CHECK_EQUAL( stats.transactions, 4 );
+      BOOST_CHECK_EQUAL( stats.conflicting, 3 );
+      BOOST_CHECK_EQUAL( stats.rounds, 4 );
+      speculative_execution_stats spec = db4.get_last_block_speculation_stats();
+      BOOST_CHECK_EQUAL( spec.speculated, 4 );
+      BOOST_CHECK_EQUAL( spec.reused, 1 );
+      BOOST_CHECK_EQUAL( spec.reevaluated, 3 );
+
+      // the first two transfers are independent, the third one pays init4 like the first one
+      transfer( account( "init0" ), account( "init4" ), 100 );
+      transfer( account( "init1" ), account( "init5" ), 100 );
+      transfer( account( "init2" ), account( "init4" ), 100 );
+      stats = apply_next_block();
+      BOOST_CHECK_EQUAL( stats.transactions, 3 );
+      BOOST_CHECK_EQUAL( stats.conflicting, 1 );
+      BOOST_CHECK_EQUAL( stats.rounds, 2 );
+      // no transfer reads what an earlier one wrote, paying the same account does not matter
+      spec = db4.get_last_block_speculation_stats();
+      BOOST_CHECK_EQUAL( spec.speculated, 3 );
+      BOOST_CHECK_EQUAL( spec.reused, 3 );
+      BOOST_CHECK_EQUAL( spec.reevaluated, 0 );
+
+      // the second operation spends from the balance the first one changed; init7 can only pay
+      // init8 after being paid earlier in the block, so its checks fail against the block start
+      signed_transaction trx;
+      set_expiration( db1, trx );
+      trx.operations.push_back( make_transfer( account( "init3" ), account( "init6" ), 100 ) );
+      trx.operations.push_back( make_transfer( account( "init3" ), account( "init6" ), 100 ) );
+      PUSH_TX( db1, trx, skip_sigs );
+      transfer( account( "init0" ), account( "init7" ), 100 );
+      transfer( account( "init7" ), account( "init8" ), 50 );
+      apply_next_block();
+      spec = db4.get_last_block_speculation_stats();
+      BOOST_CHECK_EQUAL( spec.speculated, 3 );
+      BOOST_CHECK_EQUAL( spec.reused, 2 );
+      BOOST_CHECK_EQUAL( spec.reevaluated, 1 );
+      BOOST_CHECK_EQUAL( db4.get_balance( account( "init8" ), asset_id_type() ).amount.value, 50 );
+
+      stats = apply_next_block();
+      BOOST_CHECK_EQUAL( stats.transactions, 0 );
+      BOOST_CHECK_EQUAL( db2.head_block_id().str(), db3.head_block_id().str() );
+      BOOST_CHECK_EQUAL( db4.head_block_id().str(), db3.head_block_id().str() );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( tapos )
 {
    try {
@@ -1189,6 +1407,38 @@ BOOST_FIXTURE_TEST_CASE( transaction_invalidated_in_cache, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( verified_transaction_cache_block_lookup, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   fc::temp_directory data_dir2( graphene::utilities::temp_directory_path() );
+   database db2;
+   db2.open( data_dir2.path(), make_genesis );
+   while( db2.head_block_num() < db.head_block_num() )
+      db2.push_block( *db.fetch_block_by_number( db2.head_block_num() + 1 ), ~0 );
+
+   signed_transaction tx;
+   transfer_operation op;
+   op.from = alice_id;
+   op.to = bob_id;
+   op.amount = asset(1000);
+   tx.operations.push_back( op );
+   set_expiration( db, tx );
+   sign( tx, alice_private_key );
+   PUSH_TX( db, tx, database::skip_nothing );
+   signed_block b = generate_block( database::skip_nothing );
+
+   // db2 never saw the transaction: the block pre-pass misses once and applying it does not look again
+   auto start = db2.get_verified_transaction_cache().get_stats();
+   db2.push_block( b, database::skip_witness_signature );
+   auto applied = db2.get_verified_transaction_cache().get_stats();
+   BOOST_CHECK_EQUAL( applied.misses, start.misses + 1 );
+   BOOST_CHECK_EQUAL( applied.hits, start.hits );
+   BOOST_CHECK_EQUAL( applied.size, start.size + 1 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( genesis_reserve_ids )
 {
    try
@@ -1237,6 +1487,511 @@ BOOST_AUTO_TEST_CASE( genesis_reserve_ids )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( recent_transaction_lookup, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+
+   signed_transaction tx;
+   transfer_operation op;
+   op.from = alice_id;
+   op.to = bob_id;
+   op.amount = asset(1000);
+   tx.operations.push_back( op );
+   set_expiration( db, tx );
+   sign( tx, alice_private_key );
+   PUSH_TX( db, tx );
+
+   // pending: served from the cache, then from the pending transactions
+   BOOST_CHECK( db.get_recent_transaction( tx.id() ).id() == tx.id() );
+   db.get_recent_transaction_cache().set_max_size( 0 );
+   BOOST_CHECK( db.get_recent_transaction_cache().get_stats().size == 0 );
+   BOOST_CHECK( db.get_recent_transaction( tx.id() ).id() == tx.id() );
+
+   // in a block: read back from the block
+   generate_block( ~uint32_t( database::skip_transaction_dupe_check ) );
+   const auto& idx = db.get_index_type<transaction_index>().indices().get<by_trx_id>();
+   auto itr = idx.find( tx.id() );
+   BOOST_REQUIRE( itr != idx.end() );
+   BOOST_CHECK_EQUAL( itr->block_num, db.head_block_num() );
+   BOOST_CHECK( itr->expiration == tx.expiration );
+   signed_transaction found = db.get_recent_transaction( tx.id() );
+   BOOST_CHECK( found.id() == tx.id() );
+   BOOST_CHECK( found.signatures == tx.signatures );
+
+   GRAPHENE_REQUIRE_THROW( db.get_recent_transaction( transaction_id_type() ), fc::exception );
+
+   // forgotten once it expires
+   generate_blocks( tx.expiration + db.get_global_properties().parameters.block_interval );
+   GRAPHENE_REQUIRE_THROW( db.get_recent_transaction( tx.id() ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( changed_objects_by_block, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   vector<std::shared_ptr<const vector<object_id_type>>> snapshots;
+   boost::signals2::scoped_connection conn = db.changed_objects_by_block.connect(
+      [&]( const std::shared_ptr<const vector<object_id_type>>& ids ) { snapshots.push_back( ids ); } );
+
+   transfer( alice_id, bob_id, asset(1000) );
+   transfer( alice_id, bob_id, asset(2000) );
+   BOOST_CHECK( snapshots.empty() );
+
+   generate_block();
+   BOOST_REQUIRE_EQUAL( snapshots.size(), 1u );
+   const auto& ids = *snapshots.front();
+   BOOST_CHECK( std::is_sorted( ids.begin(), ids.end() ) );
+   BOOST_CHECK( std::adjacent_find( ids.begin(), ids.end() ) == ids.end() );
+   object_id_type bob_balance = db.get_index_type<account_balance_index>().indices().get<by_account_asset>()
+                                   .find( boost::make_tuple( bob_id, asset_id_type() ) )->id;
+   BOOST_CHECK( std::binary_search( ids.begin(), ids.end(), bob_balance ) );
+
+   // a per-notification listener coming and going does not drop the ids collected for the block
+   {
+      boost::signals2::scoped_connection per_trx = db.changed_objects.connect( []( const vector<object_id_type>& ) {} );
+      transfer( alice_id, bob_id, asset(1000) );
+   }
+   transfer( bob_id, alice_id, asset(500) );
+   generate_block();
+   BOOST_REQUIRE_EQUAL( snapshots.size(), 2u );
+   BOOST_CHECK( std::binary_search( snapshots.back()->begin(), snapshots.back()->end(), bob_balance ) );
+
+   // nothing is collected once the last listener disconnects
+   conn.disconnect();
+   transfer( alice_id, bob_id, asset(1000) );
+   generate_block();
+   BOOST_CHECK_EQUAL( snapshots.size(), 2u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( cheap_transaction_rejections, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice, asset(100000) );
+   generate_block();
+
+   auto make_transfer = [&]( account_id_type from, account_id_type to, share_type amount ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = from;
+      op.to = to;
+      op.amount = asset( amount );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      return tx;
+   };
+
+   signed_transaction tx = make_transfer( alice_id, bob_id, 1000 );
+   sign( tx, alice_private_key );
+   PUSH_TX( db, tx );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, tx ), duplicate_transaction );
+
+   signed_transaction expired = make_transfer( alice_id, bob_id, 1001 );
+   expired.expiration = db.head_block_time() - 1;
+   sign( expired, alice_private_key );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, expired ), expired_transaction );
+
+   signed_transaction unsigned_tx = make_transfer( alice_id, bob_id, 1002 );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, unsigned_tx ), tx_missing_active_auth );
+
+   signed_transaction overdraft = make_transfer( bob_id, alice_id, 1000000 );
+   sign( overdraft, bob_private_key );
+   GRAPHENE_REQUIRE_THROW( PUSH_TX( db, overdraft ), insufficient_funds );
+
+   // none of the rejected transactions made it into the pending state or the next block
+   generate_block();
+   BOOST_CHECK_EQUAL( db.fetch_block_by_number( db.head_block_num() )->transactions.size(), 1u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( pending_transaction_pool_limits, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   auto push_transfer = [&]( share_type amount, share_type fee, fc::time_point_sec expiration ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( amount );
+      op.fee = asset( fee );
+      tx.operations.push_back( op );
+      tx.expiration = expiration;
+      sign( tx, alice_private_key );
+      PUSH_TX( db, tx );
+      return tx.id();
+   };
+
+   auto& pool = db.get_pending_transaction_pool();
+   pool.set_limits( 2, 1024 * 1024 );
+   fc::time_point_sec soon = db.head_block_time() + db.get_global_properties().parameters.block_interval;
+   fc::time_point_sec later = db.head_block_time() + 3600;
+
+   auto cheap = push_transfer( 1, 10, soon );
+   auto rich = push_transfer( 2, 1000, later );
+   BOOST_CHECK_EQUAL( pool.size(), 2u );
+   BOOST_CHECK_EQUAL( pool.count_by_fee_payer( alice_id ), 2u );
+
+   // a full pool refuses transactions paying no more than its cheapest entry
+   GRAPHENE_REQUIRE_THROW( push_transfer( 3, 10, later ), pending_pool_full );
+   BOOST_CHECK_EQUAL( pool.get_stats().refused, 1u );
+
+   // and evicts its cheapest entry for one paying more
+   auto medium = push_transfer( 4, 100, later );
+   BOOST_CHECK( !pool.contains( cheap ) );
+   BOOST_CHECK( pool.contains( rich ) );
+   BOOST_CHECK( pool.contains( medium ) );
+   BOOST_CHECK_EQUAL( pool.get_stats().evicted, 1u );
+   BOOST_CHECK( pool.find( medium )->id() == medium );
+   BOOST_CHECK( db.get_recent_transaction( medium ).id() == medium );
+
+   // blocks are built from the pool, not from the pending state
+   generate_block();
+   auto block = db.fetch_block_by_number( db.head_block_num() );
+   BOOST_REQUIRE( block.valid() );
+   BOOST_REQUIRE_EQUAL( block->transactions.size(), 2u );
+   BOOST_CHECK( block->transactions[0].id() == rich );
+   BOOST_CHECK( block->transactions[1].id() == medium );
+   BOOST_CHECK( pool.empty() );
+
+   // expired transactions are dropped by expiration order
+   pool.set_limits( 100, 1024 * 1024 );
+   soon = db.head_block_time() + db.get_global_properties().parameters.block_interval;
+   auto short_lived = push_transfer( 5, 10, soon );
+   auto long_lived = push_transfer( 6, 10, later );
+   BOOST_CHECK_EQUAL( pool.remove_expired( soon + 1 ), 1u );
+   BOOST_CHECK( !pool.contains( short_lived ) );
+   BOOST_CHECK( pool.contains( long_lived ) );
+   BOOST_CHECK_EQUAL( pool.get_stats().expired, 1u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( pending_pool_readmits_popped_transactions, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   uint32_t amount = 0;
+   auto push_transfer = [&]() {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( ++amount );
+      op.fee = asset( 10 );
+      tx.operations.push_back( op );
+      tx.expiration = db.head_block_time() + 3600;
+      sign( tx, alice_private_key );
+      PUSH_TX( db, tx );
+      return tx.id();
+   };
+
+   auto& pool = db.get_pending_transaction_pool();
+   pool.set_limits( 2, 1024 * 1024 );
+   auto first = push_transfer();
+   auto second = push_transfer();
+   generate_block();
+   auto third = push_transfer();
+   generate_block();
+
+   // the three popped transactions do not fit, but none of them is refused on the way back:
+   // the pool takes them all and then evicts the most recent of the equally paying ones
+   db.pop_block();
+   db.pop_block();
+   auto before = pool.get_stats();
+   generate_block();
+   auto after = pool.get_stats();
+   BOOST_CHECK_EQUAL( after.refused, before.refused );
+   BOOST_CHECK_EQUAL( after.evicted, before.evicted + 1 );
+   BOOST_CHECK( pool.contains( first ) );
+   BOOST_CHECK( pool.contains( second ) );
+   BOOST_CHECK( !pool.contains( third ) );
+
+   // new transactions are still refused by the full pool
+   GRAPHENE_REQUIRE_THROW( push_transfer(), pending_pool_full );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( pending_fee_payer_quota, database_fixture )
+{ try {
+   ACTORS( (alice)(mallory) );
+   fund( alice );
+   fund( mallory );
+   generate_block();
+
+   uint32_t amount = 0;
+   auto push_transfer = [&]( account_id_type from, const fc::ecc::private_key& key, account_id_type to ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = from;
+      op.to = to;
+      op.amount = asset( ++amount );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, key );
+      PUSH_TX( db, tx );
+   };
+
+   auto& pool = db.get_pending_transaction_pool();
+   pool.set_fee_payer_quota( 5, 0 );
+
+   // a flooding account is held to its quota
+   uint32_t refused = 0;
+   for( uint32_t i = 0; i < 20; ++i )
+   {
+      try
+      {
+         push_transfer( mallory_id, mallory_private_key, alice_id );
+      }
+      catch( const pending_fee_payer_quota& )
+      {
+         ++refused;
+      }
+   }
+   BOOST_CHECK_EQUAL( refused, 15u );
+   BOOST_CHECK_EQUAL( pool.count_by_fee_payer( mallory_id ), 5u );
+   BOOST_CHECK_EQUAL( pool.get_stats().over_quota, 15u );
+
+   // without crowding out the others
+   for( uint32_t i = 0; i < 5; ++i )
+      push_transfer( alice_id, alice_private_key, mallory_id );
+   BOOST_CHECK_EQUAL( pool.count_by_fee_payer( alice_id ), 5u );
+
+   // exempt accounts are not limited
+   pool.set_quota_exempt_fee_payers( { alice_id } );
+   push_transfer( alice_id, alice_private_key, mallory_id );
+   BOOST_CHECK_EQUAL( pool.count_by_fee_payer( alice_id ), 6u );
+   GRAPHENE_REQUIRE_THROW( push_transfer( mallory_id, mallory_private_key, alice_id ), pending_fee_payer_quota );
+
+   // the quota frees up once the transactions are in a block
+   generate_block();
+   BOOST_CHECK( pool.empty() );
+   push_transfer( mallory_id, mallory_private_key, alice_id );
+
+   // quota by bytes
+   pool.set_fee_payer_quota( 0, pool.entries().begin()->size * 2 );
+   push_transfer( mallory_id, mallory_private_key, alice_id );
+   GRAPHENE_REQUIRE_THROW( push_transfer( mallory_id, mallory_private_key, alice_id ), pending_fee_payer_quota );
+   BOOST_CHECK_EQUAL( pool.count_by_fee_payer( mallory_id ), 2u );
+
+   // transactions of popped blocks were admitted once and are not held to the quota again
+   pool.set_fee_payer_quota( 2, 0 );
+   generate_block();
+   push_transfer( mallory_id, mallory_private_key, alice_id );
+   push_transfer( mallory_id, mallory_private_key, alice_id );
+   generate_block();
+   db.pop_block();
+   db.pop_block();
+   uint64_t over_quota = pool.get_stats().over_quota;
+   generate_block();
+   BOOST_CHECK_EQUAL( pool.count_by_fee_payer( mallory_id ), 4u );
+   BOOST_CHECK_EQUAL( pool.get_stats().over_quota, over_quota );
+   GRAPHENE_REQUIRE_THROW( push_transfer( mallory_id, mallory_private_key, alice_id ), pending_fee_payer_quota );
+
+   // the totals of each fee payer follow the entries leaving the pool
+   generate_block();
+   BOOST_CHECK_EQUAL( pool.count_by_fee_payer( mallory_id ), 0u );
+   push_transfer( mallory_id, mallory_private_key, alice_id );
+   push_transfer( mallory_id, mallory_private_key, alice_id );
+   BOOST_CHECK_EQUAL( pool.count_by_fee_payer( mallory_id ), 2u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( block_packed_by_fee_density, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   fund( bob );
+   generate_block();
+
+   auto push_transfer = [&]( account_id_type from, const fc::ecc::private_key& key, account_id_type to,
+                             share_type fee ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = from;
+      op.to = to;
+      op.amount = asset( 100 );
+      op.fee = asset( fee );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, key );
+      PUSH_TX( db, tx );
+      return tx.id();
+   };
+
+   auto alice_cheap = push_transfer( alice_id, alice_private_key, bob_id, 1 );
+   auto bob_medium = push_transfer( bob_id, bob_private_key, alice_id, 100 );
+   auto alice_rich = push_transfer( alice_id, alice_private_key, bob_id, 1000 );
+
+   // bob's transfer pays more than alice's first one, which has to come before her second
+   generate_block();
+   auto block = db.fetch_block_by_number( db.head_block_num() );
+   BOOST_REQUIRE( block.valid() );
+   BOOST_REQUIRE_EQUAL( block->transactions.size(), 3u );
+   BOOST_CHECK( block->transactions[0].id() == bob_medium );
+   BOOST_CHECK( block->transactions[1].id() == alice_cheap );
+   BOOST_CHECK( block->transactions[2].id() == alice_rich );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( preassembled_block_candidate, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   auto push_transfer = [&]( share_type amount ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( amount );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, alice_private_key );
+      PUSH_TX( db, tx );
+      return tx.id();
+   };
+
+   auto early = push_transfer( 100 );
+   BOOST_CHECK_EQUAL( db.prepare_block_candidate(), 1u );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 100 );
+
+   // pushed after the candidate was assembled, appended to it
+   auto late = push_transfer( 200 );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 300 );
+
+   generate_block();
+   auto block = db.fetch_block_by_number( db.head_block_num() );
+   BOOST_REQUIRE( block.valid() );
+   BOOST_REQUIRE_EQUAL( block->transactions.size(), 2u );
+   BOOST_CHECK( block->transactions[0].id() == early );
+   BOOST_CHECK( block->transactions[1].id() == late );
+   BOOST_CHECK( db.get_pending_transaction_pool().empty() );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 300 );
+
+   const block_generation_timings& timings = db.get_last_generation_timings();
+   BOOST_CHECK_EQUAL( timings.block_num, db.head_block_num() );
+   BOOST_CHECK_EQUAL( timings.transactions, 2u );
+   BOOST_CHECK( timings.preassembled );
+   BOOST_CHECK_EQUAL( timings.assemble_us, 0 );
+   BOOST_CHECK( timings.sign_us + timings.apply_us + timings.restore_pending_us <= timings.total_us );
+
+   // without a candidate the block is assembled by generate_block()
+   push_transfer( 300 );
+   generate_block();
+   BOOST_CHECK( !db.get_last_generation_timings().preassembled );
+   BOOST_CHECK_EQUAL( db.get_last_generation_timings().transactions, 1u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( block_candidate_keeps_postponed_transactions, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+
+   auto make_transfer = [&]( share_type amount ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = bob_id;
+      op.amount = asset( amount );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, alice_private_key );
+      return tx;
+   };
+
+   // blocks only have room for one transfer
+   size_t transfer_size = fc::raw::pack_size( make_transfer( 100 ) );
+   db.modify( db.get_global_properties(), [&]( global_property_object& p ) {
+      p.parameters.maximum_block_size = fc::raw::pack_size( signed_block_header() ) + 4 + transfer_size + transfer_size / 2;
+   });
+
+   signed_transaction first = make_transfer( 100 );
+   PUSH_TX( db, first );
+   PUSH_TX( db, make_transfer( 200 ) );
+   PUSH_TX( db, make_transfer( 400 ) );
+   BOOST_CHECK_EQUAL( db.prepare_block_candidate(), 1u );
+
+   // the transfers which did not fit are still applied to the pending state
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 700 );
+   PUSH_TX( db, make_transfer( 800 ) );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 1500 );
+   BOOST_CHECK_EQUAL( db.get_pending_transaction_pool().size(), 4u );
+
+   // and only the candidate goes into the block
+   generate_block();
+   auto block = db.fetch_block_by_number( db.head_block_num() );
+   BOOST_REQUIRE( block.valid() );
+   BOOST_REQUIRE_EQUAL( block->transactions.size(), 1u );
+   BOOST_CHECK( block->transactions[0].id() == first.id() );
+   BOOST_CHECK_EQUAL( db.get_pending_transaction_pool().size(), 3u );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 1500 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( pending_transactions_carried_over, database_fixture )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+   generate_block();
+   witness_id_type producer = db.get_scheduled_witness( 1 );
+   account_id_type producer_account_id = producer(db).witness_account;
+
+   signed_transaction transfer_tx;
+   transfer_operation xfer;
+   xfer.from = alice_id;
+   xfer.to = bob_id;
+   xfer.amount = asset( 1000 );
+   transfer_tx.operations.push_back( xfer );
+   set_expiration( db, transfer_tx );
+   sign( transfer_tx, alice_private_key );
+   PUSH_TX( db, transfer_tx );
+
+   // updates the witness which signs the next block
+   signed_transaction witness_tx;
+   witness_update_operation wup;
+   wup.witness = producer;
+   wup.witness_account = producer_account_id;
+   wup.new_url = "http://example.com";
+   witness_tx.operations.push_back( wup );
+   set_expiration( db, witness_tx );
+   sign( witness_tx, init_account_priv_key );
+   PUSH_TX( db, witness_tx );
+
+   auto& pool = db.get_pending_transaction_pool();
+   BOOST_REQUIRE_EQUAL( pool.size(), 2u );
+   BOOST_REQUIRE( pool.find( transfer_tx.id() ).valid() );
+   uint64_t added = pool.get_stats().added;
+
+   // a block without the pending transactions
+   signed_block empty;
+   empty.previous = db.head_block_id();
+   empty.timestamp = db.get_slot_time( 1 );
+   empty.witness = producer;
+   empty.transaction_merkle_root = empty.calculate_merkle_root();
+   empty.sign( init_account_priv_key );
+   PUSH_BLOCK( db, empty );
+
+   // the transfer accessed nothing the block changed and is carried over, the witness update
+   // is verified again
+   BOOST_CHECK_EQUAL( pool.size(), 2u );
+   BOOST_CHECK_EQUAL( pool.get_stats().carried_over, 1u );
+   BOOST_CHECK_EQUAL( pool.get_stats().added, added + 1 );
+   BOOST_CHECK( pool.contains( transfer_tx.id() ) );
+   BOOST_CHECK( pool.contains( witness_tx.id() ) );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 1000 );
+   BOOST_CHECK_EQUAL( producer(db).url, "http://example.com" );
+
+   // both are still included in the next block
+   generate_block();
+   BOOST_CHECK( pool.empty() );
+   auto block = db.fetch_block_by_number( db.head_block_num() );
+   BOOST_REQUIRE( block.valid() );
+   BOOST_CHECK_EQUAL( block->transactions.size(), 2u );
+   BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 1000 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_FIXTURE_TEST_CASE( miss_many_blocks, database_fixture )
 {
    try
@@ -602,6 +602,44 @@ BOOST_AUTO_TEST_CASE( account_create_fee_scaling )
    BOOST_CHECK_EQUAL(db.get_global_properties().parameters.current_fees->get<account_create_operation>().basic_fee, 1);
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( fee_lookup_table )
+{ try {
+   fee_schedule fees = fee_schedule::get_default();
+   fees.scale = GRAPHENE_100_PERCENT / 2;
+   fees.get<transfer_operation>().fee = 1234;
+   // leave one type without parameters, its fee comes from the defaults
+   fee_parameters missing; missing.set_which( operation::tag<account_upgrade_operation>::value );
+   fees.parameters.erase( missing );
+
+   vector<operation> ops( operation::count() );
+   vector<asset> searched;
+   for( int i = 0; i < operation::count(); ++i )
+   {
+      ops[i].set_which( i );
+      searched.push_back( fees.calculate_fee( ops[i] ) );
+   }
+
+   BOOST_CHECK( !fees.has_lookup_table() );
+   fees.build_lookup_table();
+   BOOST_CHECK( fees.has_lookup_table() );
+   for( int i = 0; i < operation::count(); ++i )
+      BOOST_CHECK( fees.calculate_fee( ops[i] ) == searched[i] );
+   BOOST_CHECK( fees.calculate_core_fee( transfer_operation() ) == 617 );
+   BOOST_CHECK( fees.calculate_core_fee( account_upgrade_operation() ) ==
+                searched[ operation::tag<account_upgrade_operation>::value ].amount );
+
+   // copies share the table, changing the parameters drops it
+   fee_schedule copy = fees;
+   BOOST_CHECK( copy.has_lookup_table() );
+   copy.get<transfer_operation>().fee = 2000;
+   BOOST_CHECK( !copy.has_lookup_table() );
+   BOOST_CHECK( copy.calculate_core_fee( transfer_operation() ) == 1000 );
+   BOOST_CHECK( fees.calculate_core_fee( transfer_operation() ) == 617 );
+
+   // the database keeps a table for the current schedule
+   BOOST_CHECK( db.current_fee_schedule().has_lookup_table() );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( fee_refund_test )
 {
    try
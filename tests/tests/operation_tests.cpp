@@ -396,6 +396,97 @@ BOOST_AUTO_TEST_CASE( black_swan_issue_346 )
    }
 }
 
+/**
+ * When feeds expire, the medians of all assets are refreshed before their margin
+ * calls are checked.  Each asset must end up with exactly the fills it would get
+ * from being checked right after its own feed.
+ */
+BOOST_AUTO_TEST_CASE( expired_feed_margin_calls )
+{ try {
+      generate_blocks( HARDFORK_615_TIME );
+      generate_block();
+      set_expiration( db, trx );
+
+      ACTORS((seller)(borrower)(borrower2)(early_feeder)(late_feeder));
+
+      const asset_object& core = asset_id_type()(db);
+      const int64_t init_balance(1000000);
+
+      transfer(committee_account, seller_id, asset(init_balance));
+      transfer(committee_account, borrower_id, asset(init_balance));
+      transfer(committee_account, borrower2_id, asset(init_balance));
+
+      vector<asset_id_type> assets;
+      vector<call_order_id_type> calls;
+      vector<call_order_id_type> safe_calls;
+      vector<limit_order_id_type> orders;
+      fc::time_point_sec early_time = db.head_block_time();
+      for( const string symbol : { "USDBIT", "CNYBIT" } )
+      {
+         const asset_object& bitusd = create_bitasset( symbol, early_feeder_id );
+         update_feed_producers( bitusd, {early_feeder.id, late_feeder.id} );
+
+         price_feed feed;
+         feed.settlement_price = bitusd.amount(100) / core.amount(100);
+         publish_feed( bitusd, early_feeder, feed );
+
+         // 2:1 collateral, called once the feed falls to 1.5 CORE
+         calls.push_back( borrow( borrower, bitusd.amount(1000), asset(2000) )->id );
+         safe_calls.push_back( borrow( borrower2, bitusd.amount(1000), asset(10000) )->id );
+         transfer( borrower2, seller, bitusd.amount(1000) );
+
+         // both are outside of the short squeeze range until the feed falls
+         const limit_order_object* order = create_sell_order( seller, bitusd.amount(100), core.amount(200) );
+         BOOST_REQUIRE( order != nullptr );
+         orders.push_back( order->id );
+         order = create_sell_order( seller, bitusd.amount(100), core.amount(210) );
+         BOOST_REQUIRE( order != nullptr );
+         orders.push_back( order->id );
+
+         assets.push_back( bitusd.id );
+      }
+      int64_t seller_core = get_balance( seller, core );
+
+      generate_blocks( db.head_block_time() + 60*60 );
+      set_expiration( db, trx );
+      for( asset_id_type id : assets )
+      {
+         price_feed feed;
+         feed.settlement_price = id(db).amount(100) / core.amount(150);
+         publish_feed( id(db), late_feeder, feed );
+         // the median is still the early feed
+         BOOST_CHECK( id(db).bitasset_data(db).current_feed.settlement_price == id(db).amount(100) / core.amount(100) );
+      }
+      for( limit_order_id_type id : orders )
+         BOOST_CHECK( db.find_object( id ) != nullptr );
+
+      // the early feeds expire together, both assets are called in the same block
+      generate_blocks( early_time + GRAPHENE_DEFAULT_PRICE_FEED_LIFETIME );
+      generate_block();
+
+      for( size_t i = 0; i < assets.size(); ++i )
+      {
+         const asset_object& bitusd = assets[i](db);
+         BOOST_CHECK( bitusd.bitasset_data(db).current_feed.settlement_price == bitusd.amount(100) / core.amount(150) );
+         BOOST_CHECK( !bitusd.bitasset_data(db).has_settlement() );
+
+         const call_order_object& call = calls[i](db);
+         BOOST_CHECK_EQUAL( call.debt.value, 800 );
+         BOOST_CHECK_EQUAL( call.collateral.value, 2000 - 200 - 210 );
+         const call_order_object& safe_call = safe_calls[i](db);
+         BOOST_CHECK_EQUAL( safe_call.debt.value, 1000 );
+         BOOST_CHECK_EQUAL( safe_call.collateral.value, 10000 );
+         BOOST_CHECK_EQUAL( get_balance( seller, bitusd ), 800 );
+      }
+      for( limit_order_id_type id : orders )
+         BOOST_CHECK( db.find_object( id ) == nullptr );
+      BOOST_CHECK_EQUAL( get_balance( seller, core ), seller_core + 2 * (200 + 210) );
+   } catch( const fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( prediction_market )
 { try {
       ACTORS((judge)(dan)(nathan));
@@ -1817,4 +1908,44 @@ BOOST_AUTO_TEST_CASE( vesting_balance_withdraw_test )
 
 // TODO:  Write linear VBO tests
 
+BOOST_AUTO_TEST_CASE( operation_profiler_records_evaluators )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice );
+
+   operation_profiler& profiler = db.get_operation_profiler();
+   profiler.reset();
+   transfer( alice, bob, asset(1000) );
+   // disabled by default
+   BOOST_CHECK( profiler.get_stats().empty() );
+
+   profiler.enable( true );
+   transfer( alice, bob, asset(1000) );
+   transfer( alice, bob, asset(1000) );
+   profiler.enable( false );
+
+   auto stats = profiler.get_stats();
+   BOOST_REQUIRE_EQUAL( stats.size(), 1 );
+   BOOST_CHECK_EQUAL( stats[0].operation_tag, operation::tag<transfer_operation>::value );
+   BOOST_CHECK_EQUAL( stats[0].operation_name, "graphene::chain::transfer_operation" );
+   BOOST_CHECK_EQUAL( stats[0].fee.count, 2 );
+   BOOST_CHECK_EQUAL( stats[0].evaluate.count, 2 );
+   BOOST_CHECK_EQUAL( stats[0].apply.count, 2 );
+   uint64_t bucketed = 0;
+   for( auto b : stats[0].apply.buckets )
+      bucketed += b;
+   BOOST_CHECK_EQUAL( bucketed, 2 );
+
+   // bucket i holds samples of [2^i, 2^(i+1)) nanoseconds
+   profiler.reset();
+   profiler.record( operation::tag<transfer_operation>::value, operation_profiler::evaluate_phase, 1000 );
+   stats = profiler.get_stats();
+   BOOST_REQUIRE_EQUAL( stats.size(), 1 );
+   BOOST_REQUIRE_EQUAL( stats[0].evaluate.buckets.size(), 10 );
+   BOOST_CHECK_EQUAL( stats[0].evaluate.buckets[9], 1 );
+   BOOST_CHECK_EQUAL( stats[0].evaluate.max_ns, 1000 );
+   BOOST_CHECK_EQUAL( stats[0].fee.count, 0 );
+   BOOST_CHECK( profiler.report().find( "transfer_operation" ) != string::npos );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1484,6 +1484,189 @@ BOOST_AUTO_TEST_CASE( top_n_special )
    } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( balances_by_asset_order )
+{ try {
+   ACTORS( (alice)(bob)(chloe)(dan) );
+   vector<account_id_type> accounts = { alice_id, bob_id, chloe_id, dan_id };
+
+   const auto& bal_index = db.get_index_type<account_balance_index>();
+   const auto& by_amount = dynamic_cast< const primary_index<account_balance_index>& >( bal_index )
+                              .get_secondary_index<balances_by_asset_index>();
+
+   auto check_order = [&]()
+   {
+      vector<const account_balance_object*> expected;
+      for( const account_balance_object& b : bal_index.indices() )
+         if( b.asset_type == asset_id_type() )
+            expected.push_back( &b );
+      std::sort( expected.begin(), expected.end(), []( const account_balance_object* a, const account_balance_object* b ) {
+         return a->balance != b->balance ? a->balance > b->balance : a->owner < b->owner;
+      });
+      BOOST_CHECK( by_amount.get_balances_by_amount( asset_id_type() ) == expected );
+   };
+
+   check_order();
+   for( uint32_t i = 0; i < 40; ++i )
+   {
+      fund( accounts[ (i * 7) % accounts.size() ]( db ), asset( 1000 + (i * 7919) % 5000 ) );
+      if( i % 3 == 0 )
+         transfer( accounts[ i % accounts.size() ], accounts[ (i + 1) % accounts.size() ], asset( 500 ) );
+      if( i % 5 == 0 )
+         check_order();
+   }
+   check_order();
+
+   // balances restored by undo and recreated by later blocks stay in order
+   generate_block();
+   fund( dan_id( db ), asset( 123456 ) );
+   check_order();
+   db.pop_block();
+   check_order();
+   generate_block();
+   check_order();
+   BOOST_CHECK( by_amount.get_balances_by_amount( asset_id_type( 100 ) ).empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( balances_by_asset_pending_changes_bounded )
+{ try {
+   ACTORS( (alice) );
+
+   const auto& by_amount = dynamic_cast< const primary_index<account_balance_index>& >( db.get_index_type<account_balance_index>() )
+                              .get_secondary_index<balances_by_asset_index>();
+   by_amount.get_balances_by_amount( asset_id_type() );
+   BOOST_CHECK_EQUAL( by_amount.pending_changes( asset_id_type() ), 0 );
+
+   // every transfer modifies the same two CORE balances, which are only tracked once
+   for( uint32_t i = 0; i < 200; ++i )
+   {
+      fund( alice, asset( 1 ) );
+      BOOST_CHECK_LE( by_amount.pending_changes( asset_id_type() ), 2 );
+   }
+
+   // undoing and redoing blocks does not grow them past the balances of the asset either
+   auto core_balances = [&]()
+   {
+      size_t count = 0;
+      for( const account_balance_object& b : db.get_index_type<account_balance_index>().indices() )
+         if( b.asset_type == asset_id_type() )
+            ++count;
+      return count;
+   };
+   generate_block();
+   for( uint32_t i = 0; i < 20; ++i )
+   {
+      fund( alice, asset( 1 ) );
+      generate_block();
+      db.pop_block();
+      BOOST_CHECK_LE( by_amount.pending_changes( asset_id_type() ), 2 * core_balances() );
+   }
+
+   BOOST_CHECK_EQUAL( by_amount.get_balances_by_amount( asset_id_type() ).size(), core_balances() );
+   BOOST_CHECK_EQUAL( by_amount.pending_changes( asset_id_type() ), 0 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( balances_by_asset_undo_remove )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice, asset( 5000 ) );
+   fund( bob, asset( 7000 ) );
+
+   const auto& bal_index = db.get_index_type<account_balance_index>();
+   const auto& by_amount = dynamic_cast< const primary_index<account_balance_index>& >( bal_index )
+                              .get_secondary_index<balances_by_asset_index>();
+   auto core_owners = [&]()
+   {
+      vector<account_id_type> owners;
+      for( const account_balance_object* b : by_amount.get_balances_by_amount( asset_id_type() ) )
+         owners.push_back( b->owner );
+      return owners;
+   };
+   const vector<account_id_type> before = core_owners();
+
+   const account_balance_object* alice_balance = nullptr;
+   for( const account_balance_object& b : bal_index.indices() )
+      if( b.owner == alice_id && b.asset_type == asset_id_type() )
+         alice_balance = &b;
+   BOOST_REQUIRE( alice_balance != nullptr );
+
+   // undo puts the removed balance back through primary_index::insert, which must notify the index
+   {
+      auto session = db._undo_db.start_undo_session();
+      db.remove( *alice_balance );
+      vector<account_id_type> removed = core_owners();
+      BOOST_CHECK( std::find( removed.begin(), removed.end(), alice_id ) == removed.end() );
+      BOOST_CHECK_EQUAL( removed.size(), before.size() - 1 );
+   }
+   BOOST_CHECK( core_owners() == before );
+   BOOST_CHECK_EQUAL( by_amount.pending_changes( asset_id_type() ), 0 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( limit_order_price_levels )
+{ try {
+   ACTORS( (alice)(bob) );
+   const asset_object& test_asset = create_user_issued_asset( "TEST" );
+   asset_id_type test_id = test_asset.id;
+   issue_uia( alice, test_asset.amount( 100000 ) );
+   fund( bob, asset( 100000 ) );
+
+   const auto& order_index = db.get_index_type<limit_order_index>();
+   const auto& levels = dynamic_cast< const primary_index<limit_order_index>& >( order_index )
+                           .get_secondary_index<limit_order_price_level_index>();
+
+   // the levels must be the orders of the by_price index, summed at equal prices
+   auto check_levels = [&]( asset_id_type sell, asset_id_type receive ) -> size_t
+   {
+      const auto& by_price_idx = order_index.indices().get<by_price>();
+      auto itr = by_price_idx.lower_bound( price::max( sell, receive ) );
+      auto end = by_price_idx.upper_bound( price::min( sell, receive ) );
+      auto range = levels.get_levels( sell, receive );
+      size_t level_count = 0;
+      for( auto level_itr = range.first; level_itr != range.second; ++level_itr, ++level_count )
+      {
+         const auto& level = level_itr->second;
+         fc::uint128 for_sale = 0;
+         fc::uint128 to_receive = 0;
+         uint32_t order_count = 0;
+         for( ; itr != end && itr->sell_price == level.sell_price; ++itr )
+         {
+            for_sale += uint64_t( itr->for_sale.value );
+            to_receive += uint64_t( itr->amount_to_receive().amount.value );
+            ++order_count;
+         }
+         BOOST_CHECK( level.for_sale == for_sale );
+         BOOST_CHECK( level.to_receive == to_receive );
+         BOOST_CHECK_EQUAL( level.order_count, order_count );
+      }
+      BOOST_CHECK( itr == end );
+      return level_count;
+   };
+
+   create_sell_order( alice_id, asset( 100, test_id ), asset( 200 ) );
+   create_sell_order( alice_id, asset( 300, test_id ), asset( 900 ) );
+   create_sell_order( alice_id, asset( 100, test_id ), asset( 200 ) );
+   // 1/2 and 50/100 are the same price
+   limit_order_id_type half_id = create_sell_order( alice_id, asset( 50, test_id ), asset( 100 ) )->id;
+   create_sell_order( bob_id, asset( 100 ), asset( 100, test_id ) );
+   BOOST_CHECK_EQUAL( check_levels( test_id, asset_id_type() ), 2u );
+   BOOST_CHECK_EQUAL( check_levels( asset_id_type(), test_id ), 1u );
+   BOOST_CHECK_EQUAL( levels.get_levels( test_id, asset_id_type() ).first->second.order_count, 3u );
+
+   // partially fills the first order of the best level
+   generate_block();
+   create_sell_order( bob_id, asset( 100 ), asset( 50, test_id ) );
+   BOOST_CHECK_EQUAL( check_levels( test_id, asset_id_type() ), 2u );
+   cancel_limit_order( half_id( db ) );
+   BOOST_CHECK_EQUAL( check_levels( test_id, asset_id_type() ), 2u );
+
+   // undoing the cancel restores the order before the block removes it again
+   db.pop_block();
+   BOOST_CHECK_EQUAL( check_levels( test_id, asset_id_type() ), 0u );
+   BOOST_CHECK_EQUAL( check_levels( asset_id_type(), test_id ), 0u );
+   generate_block();
+   BOOST_CHECK_EQUAL( check_levels( test_id, asset_id_type() ), 2u );
+   BOOST_CHECK_EQUAL( check_levels( asset_id_type(), test_id ), 1u );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( buyback )
 {
    ACTORS( (alice)(bob)(chloe)(dan)(izzy)(philbin) );
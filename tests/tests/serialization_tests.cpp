@@ -148,4 +148,57 @@ BOOST_AUTO_TEST_CASE( extension_serialization_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( sealed_transaction_and_block_test )
+{
+   try
+   {
+      fc::ecc::private_key key = generate_private_key( "sealer" );
+      signed_block b;
+      for( uint32_t i = 0; i < 5; ++i )
+      {
+         transfer_operation op;
+         op.from = account_id_type(1);
+         op.to = account_id_type(2);
+         op.amount = asset( i + 1 );
+         processed_transaction ptx;
+         ptx.operations.push_back( op );
+         ptx.set_expiration( db.head_block_time() + fc::minutes(1) );
+         ptx.sign( key, db.get_chain_id() );
+         ptx.operation_results.push_back( void_result() );
+         b.transactions.push_back( ptx );
+      }
+      b.previous = db.head_block_id();
+      b.timestamp = db.head_block_time() + db.get_global_properties().parameters.block_interval;
+      b.transaction_merkle_root = b.calculate_merkle_root();
+      b.sign( key );
+
+      for( const processed_transaction& ptx : b.transactions )
+      {
+         sealed_transaction sealed( ptx, db.get_chain_id() );
+         BOOST_CHECK( sealed.id() == ptx.id() );
+         BOOST_CHECK( sealed.digest() == ptx.digest() );
+         BOOST_CHECK( sealed.sig_digest() == ptx.sig_digest( db.get_chain_id() ) );
+         BOOST_CHECK( sealed.merkle_digest() == ptx.merkle_digest() );
+         BOOST_CHECK( sealed.packed() == fc::raw::pack( ptx ) );
+         BOOST_CHECK_EQUAL( sealed.signed_packed_size(), fc::raw::pack_size( signed_transaction( ptx ) ) );
+         BOOST_CHECK( sealed.get_signature_keys() == ptx.get_signature_keys( db.get_chain_id() ) );
+      }
+
+      sealed_block sealed( b, db.get_chain_id() );
+      BOOST_CHECK( sealed.id() == b.id() );
+      BOOST_CHECK( sealed.digest() == b.digest() );
+      BOOST_CHECK_EQUAL( sealed.packed_size(), fc::raw::pack_size( b ) );
+      BOOST_CHECK( sealed.calculate_merkle_root() == b.transaction_merkle_root );
+      BOOST_CHECK( sealed.signee() == b.signee() );
+      BOOST_REQUIRE_EQUAL( sealed.transactions().size(), b.transactions.size() );
+      BOOST_CHECK( sealed.transactions()[3].id() == b.transactions[3].id() );
+      BOOST_CHECK( sealed_block( b, db.get_chain_id() ).id() == sealed.id() );
+   }
+   catch ( const fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()